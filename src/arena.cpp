@@ -0,0 +1,209 @@
+#include "arena.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+Arena::Arena(int size, uint64_t seed, int food)
+    : size(size), stride(size + 2), rng(seed), foodTarget(food),
+      owner((size_t)(size + 2) * (size + 2), ARENA_WALL), towardHead(owner.size(), 0),
+      claimTick(owner.size(), 0), claimant(owner.size(), 0), freeCells((int)owner.size()) {
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            Vacate(GridIndex(Cell{x, y}));
+        }
+    }
+    SpawnFood();
+}
+
+int Arena::AddSnake() {
+    int id = SnakeCount();
+    head.push_back(0);
+    tail.push_back(0);
+    length.push_back(0);
+    growth.push_back(0);
+    score.push_back(0);
+    direction.push_back(0);
+    alive.push_back(0);
+    dying.push_back(0);
+    Spawn(id);
+    return id;
+}
+
+bool Arena::Spawn(int id) {
+    if (freeCells.Empty()) {
+        return false;
+    }
+    int index = freeCells.At(rng.GetRandomValue(0, freeCells.Size() - 1));
+    Occupy(index, id + 1);
+    head[id] = index;
+    tail[id] = index;
+    length[id] = 1;
+    growth[id] = startLength - 1;
+    score[id] = 0;
+    // Head for the far side of the board, so a fresh snake does not start next to a wall
+    direction[id] = (uint8_t)DirectionOf(GridCell(index).x < size / 2 ? Input::RIGHT : Input::LEFT);
+    alive[id] = 1;
+    return true;
+}
+
+void Arena::RemoveBody(int id) {
+    int cell = tail[id];
+    for (int i = 0; i < length[id]; i++) {
+        int next = cell + Offset(towardHead[cell]);
+        Vacate(cell);
+        cell = next;
+    }
+    length[id] = 0;
+}
+
+void Arena::SpawnFood() {
+    while (foodCount < foodTarget && !freeCells.Empty()) {
+        int index = freeCells.At(rng.GetRandomValue(0, freeCells.Size() - 1));
+        Occupy(index, ARENA_FOOD);
+        foodSpawned.push_back(GridCell(index));
+        foodCount++;
+    }
+}
+
+ArenaTickStats Arena::Step() {
+    ArenaTickStats stats;
+    const int snakes = SnakeCount();
+    const uint32_t stamp = tick + 1; // claimTick 0 means never claimed
+    foodSpawned.clear();
+
+    if (respawn) {
+        for (int i = 0; i < snakes; i++) {
+            if (!alive[i] && Spawn(i)) {
+                stats.spawned++;
+            }
+        }
+    }
+
+    // Tails move first, so a head may follow a tail into the cell it leaves this tick
+    for (int i = 0; i < snakes; i++) {
+        if (!alive[i]) {
+            continue;
+        }
+        dying[i] = 0;
+        if (growth[i] > 0) {
+            growth[i]--;
+            continue;
+        }
+        int oldTail = tail[i];
+        if (--length[i] > 0) {
+            tail[i] = oldTail + Offset(towardHead[oldTail]);
+        }
+        Vacate(oldTail);
+    }
+
+    // Every head claims its target cell against the grid as it was before any head moved.
+    // Walls and bodies kill; two heads claiming one cell kill each other.
+    for (int i = 0; i < snakes; i++) {
+        if (!alive[i]) {
+            continue;
+        }
+        int target = head[i] + Offset(direction[i]);
+        int32_t value = owner[target];
+        if (value == ARENA_WALL || value > 0) {
+            dying[i] = 1;
+        } else if (claimTick[target] == stamp) {
+            dying[i] = 1;
+            dying[claimant[target]] = 1;
+        } else {
+            claimTick[target] = stamp;
+            claimant[target] = i;
+        }
+    }
+
+    // Survivors move into their claimed cell, the others leave the board
+    for (int i = 0; i < snakes; i++) {
+        if (!alive[i]) {
+            continue;
+        }
+        if (dying[i]) {
+            RemoveBody(i);
+            alive[i] = 0;
+            stats.died++;
+            continue;
+        }
+        int target = head[i] + Offset(direction[i]);
+        if (owner[target] == ARENA_FOOD) {
+            growth[i]++; // The tail stays put on the next tick
+            score[i] += 10;
+            foodCount--;
+            stats.ate++;
+        }
+        if (length[i] > 0) {
+            towardHead[head[i]] = direction[i];
+        } else {
+            tail[i] = target; // A one-cell snake left its only cell
+        }
+        Occupy(target, i + 1);
+        head[i] = target;
+        length[i]++;
+        stats.moved++;
+    }
+
+    SpawnFood();
+    tick++;
+    return stats;
+}
+
+bool Arena::CheckInvariants(string& error) const {
+    vector<uint8_t> seen(owner.size(), 0);
+    int segments = 0;
+    for (int id = 0; id < SnakeCount(); id++) {
+        if (!alive[id]) {
+            continue;
+        }
+        if (length[id] < 1) {
+            error = "snake " + to_string(id) + " is alive with no segments";
+            return false;
+        }
+        int cell = tail[id];
+        for (int i = 0; i < length[id]; i++) {
+            if (owner[cell] != id + 1 || seen[cell]) {
+                error = "snake " + to_string(id) + " segment " + to_string(i) + " is not its own cell";
+                return false;
+            }
+            seen[cell] = 1;
+            segments++;
+            if (i + 1 < length[id]) {
+                cell += Offset(towardHead[cell]);
+            }
+        }
+        if (cell != head[id]) {
+            error = "snake " + to_string(id) + " body does not end at its head";
+            return false;
+        }
+    }
+
+    int owned = 0, food = 0, empty = 0;
+    for (int index = 0; index < (int)owner.size(); index++) {
+        Cell cell = GridCell(index);
+        bool wall = cell.x < 0 || cell.y < 0 || cell.x >= size || cell.y >= size;
+        if (wall != (owner[index] == ARENA_WALL)) {
+            error = "cell " + to_string(index) + " breaks the wall ring";
+            return false;
+        }
+        if (owner[index] > 0) {
+            owned++;
+        } else if (owner[index] == ARENA_FOOD) {
+            food++;
+        } else if (owner[index] == ARENA_EMPTY) {
+            empty++;
+            if (!freeCells.Contains(index)) {
+                error = "empty cell " + to_string(index) + " is missing from the free set";
+                return false;
+            }
+        }
+    }
+    if (owned != segments) {
+        error = to_string(owned) + " owned cells for " + to_string(segments) + " live segments";
+        return false;
+    }
+    if (food != foodCount || empty != freeCells.Size()) {
+        error = "food or free cell counts drifted from the grid";
+        return false;
+    }
+    return true;
+}
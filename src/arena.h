@@ -0,0 +1,197 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstdint>      // Fixed-width integer types for the per-cell and per-snake arrays
+#include <string>       // Error text of CheckInvariants
+#include <vector>       // The vector containers holding the arrays
+
+#include "cell.h"
+#include "free_cell_set.h"
+#include "simulation.h"
+
+// Headless multi-snake game: any number of snakes and food items on one
+// large board, stepped together one tick at a time. Like BasicSimulation it
+// makes no raylib calls and is fully determined by its seed and inputs.
+//
+// Snakes are stored structure-of-arrays (one vector per field, indexed by
+// snake id), so a tick walks a few dense arrays instead of chasing one
+// object per snake. The bodies live in the shared grid itself: every cell
+// records its owner and the direction to the next segment toward the head,
+// so moving a snake rewrites two cells whatever its length, and a collision
+// test is one lookup. A tick therefore costs O(snakes + cells changed).
+
+// Owner values of a grid cell besides snake ids (id + 1, always positive)
+enum ArenaCell : int32_t {
+    ARENA_EMPTY = 0,
+    ARENA_FOOD  = -1,
+    ARENA_WALL  = -2 // The ring of cells around the board
+};
+
+// What happened during one Arena::Step()
+struct ArenaTickStats {
+    int moved = 0; // Snakes that advanced
+    int died = 0; // Snakes that hit a wall, a body or another head
+    int ate = 0; // Food items eaten
+    int spawned = 0; // Snakes (re)placed on the board at the start of the tick
+};
+
+class Arena {
+    private:
+        int size; // Cells along each side of the playable board
+        int stride; // Row length of the grid, the board plus one wall cell on each side
+        Rng rng; // Seeded generator for spawns
+        uint32_t tick = 0; // Steps played so far
+        int foodTarget; // Food items kept on the board
+        int foodCount = 0; // Food items currently on the board
+        bool respawn = true; // Dead snakes come back at the start of the next tick
+        std::vector<Cell> foodSpawned; // Food cells placed during the last Step()
+
+        // Per-cell state of the padded grid, row-major
+        std::vector<int32_t> owner; // ArenaCell value or snake id + 1
+        std::vector<uint8_t> towardHead; // Direction from a segment to the next one toward the head
+        std::vector<uint32_t> claimTick; // Tick + 1 when a head last claimed the cell
+        std::vector<int32_t> claimant; // Snake that claimed the cell in claimTick
+        FreeCellSet freeCells; // Empty playable cells, for spawning snakes and food
+
+        // Per-snake state, one entry per snake id
+        std::vector<int32_t> head; // Grid index of the head
+        std::vector<int32_t> tail; // Grid index of the tail
+        std::vector<int32_t> length; // Segments on the board
+        std::vector<int32_t> growth; // Segments still to grow (the tail stays put while positive)
+        std::vector<int32_t> score; // Score of the current life
+        std::vector<uint8_t> direction; // Direction of the next move, DirectionOf() order
+        std::vector<uint8_t> alive; // Whether the snake is on the board
+        std::vector<uint8_t> dying; // Scratch: the snake dies in the current tick
+
+        // Returns the grid offset of a move in DirectionOf() order.
+        int Offset(int dir) const {
+            const int offsets[] = {-stride, stride, -1, 1};
+            return offsets[dir];
+        }
+
+        // Returns the grid index of a playable cell.
+        int GridIndex(Cell cell) const { return (cell.y + 1) * stride + cell.x + 1; }
+
+        // Returns the playable cell at a grid index.
+        Cell GridCell(int index) const { return Cell{index % stride - 1, index / stride - 1}; }
+
+        // Fills an empty cell.
+        void Occupy(int index, int32_t value) {
+            owner[index] = value;
+            freeCells.Erase(index);
+        }
+
+        // Empties a cell.
+        void Vacate(int index) {
+            owner[index] = ARENA_EMPTY;
+            freeCells.Insert(index);
+        }
+
+        // Places a dead snake on a random empty cell, returns false when the board is full.
+        bool Spawn(int id);
+
+        // Clears every segment of a snake from the grid.
+        void RemoveBody(int id);
+
+        // Tops the food back up to foodTarget.
+        void SpawnFood();
+
+    public:
+        // Starting length of every snake; a snake spawns on one cell and grows the rest.
+        static const int startLength = 3;
+
+        // Creates an empty board of 'size' x 'size' cells keeping 'food' items on it.
+        Arena(int size, uint64_t seed, int food);
+
+        // Converts an input to a direction index, -1 for Input::NONE.
+        static int DirectionOf(Input input) { return (int)input - 1; }
+
+        // Adds a snake on a random empty cell and returns its id (it stays dead if the board is full).
+        int AddSnake();
+
+        // Chooses whether dead snakes reappear at the start of the next tick.
+        void SetRespawn(bool enabled) { respawn = enabled; }
+
+        // Turns a snake for the next step, ignoring reversals into its own neck.
+        void Steer(int id, Input input) {
+            int dir = DirectionOf(input);
+            if (dir >= 0 && (length[id] == 1 || dir != (direction[id] ^ 1))) {
+                direction[id] = (uint8_t)dir;
+            }
+        }
+
+        // Advances every snake by one tick.
+        ArenaTickStats Step();
+
+        // Returns the number of cells along each side.
+        int CellCount() const { return size; }
+
+        // Returns the number of steps played.
+        uint32_t Tick() const { return tick; }
+
+        // Returns the number of snake ids handed out.
+        int SnakeCount() const { return (int)head.size(); }
+
+        // Returns the number of food items on the board.
+        int FoodCount() const { return foodCount; }
+
+        // Returns whether a snake is on the board.
+        bool IsAlive(int id) const { return alive[id] != 0; }
+
+        // Returns a snake's head cell.
+        Cell Head(int id) const { return GridCell(head[id]); }
+
+        // Returns a snake's direction as a DirectionOf() index.
+        int Direction(int id) const { return direction[id]; }
+
+        // Returns a snake's number of segments.
+        int Length(int id) const { return length[id]; }
+
+        // Returns the score of a snake's current life.
+        int Score(int id) const { return score[id]; }
+
+        // Returns the food cells placed during the last Step(), for broadcasting changes.
+        const std::vector<Cell>& FoodSpawned() const { return foodSpawned; }
+
+        // Returns the owner of a playable or wall cell (one step outside the board): an ArenaCell or id + 1.
+        int32_t Owner(Cell cell) const { return owner[GridIndex(cell)]; }
+
+        // Returns the owner of the cell one move from 'cell' in direction 'dir'.
+        int32_t OwnerAhead(Cell cell, int dir) const { return owner[GridIndex(cell) + Offset(dir)]; }
+
+        // Method to call visit(cell) for each segment of a snake, tail first
+        template <typename Visitor>
+        void ForEachSegment(int id, Visitor&& visit) const {
+            int cell = tail[id];
+            for (int i = 0; i < length[id]; i++) {
+                visit(GridCell(cell));
+                cell += Offset(towardHead[cell]);
+            }
+        }
+
+        // Rebuilds the grid from the snake arrays and compares; returns false with a description on mismatch.
+        bool CheckInvariants(std::string& error) const;
+};
+
+// Function to fold the visible state of an Arena, or of a copy kept elsewhere
+// with the same accessors (see ArenaMirror), into one 64-bit FNV-1a value
+template <typename ArenaT>
+uint64_t ArenaChecksum(const ArenaT& arena) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (int id = 0; id < arena.SnakeCount(); id++) {
+        uint64_t values[4] = {0, 0, 0, 0};
+        if (arena.IsAlive(id)) {
+            Cell head = arena.Head(id);
+            values[0] = 1;
+            values[1] = (uint64_t)arena.Length(id);
+            values[2] = (uint64_t)head.x;
+            values[3] = (uint64_t)head.y;
+        }
+        for (uint64_t value : values) {
+            hash = (hash ^ value) * 1099511628211ULL;
+        }
+    }
+    return (hash ^ (uint64_t)arena.FoodCount()) * 1099511628211ULL;
+}
+
+#endif // ARENA_H
@@ -0,0 +1,294 @@
+#include "arena_net.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Moves in the direction order of Arena::DirectionOf()
+static const Cell moveDeltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+
+void ArenaDeltaEncoder::Capture(const Arena& arena) {
+    int count = arena.SnakeCount();
+    wasAlive.resize(count);
+    lastLength.resize(count);
+    for (int id = 0; id < count; id++) {
+        wasAlive[id] = arena.IsAlive(id) ? 1 : 0;
+        lastLength[id] = arena.Length(id);
+    }
+}
+
+void ArenaDeltaEncoder::EncodeTick(const Arena& arena, vector<uint8_t>& out) {
+    int count = arena.SnakeCount();
+    int known = (int)wasAlive.size(); // Snakes added since the last capture count as dead before the step
+    out.clear();
+    NetWriter writer(out);
+    writer.Put<uint32_t>(arena.Tick());
+    writer.Put<uint64_t>(ArenaChecksum(arena));
+    writer.PutVarint((uint32_t)count);
+
+    uint32_t deaths = 0, moves = 0, spawns = 0;
+    for (int id = 0; id < count; id++) {
+        bool before = id < known && wasAlive[id];
+        if (before && !arena.IsAlive(id)) {
+            deaths++;
+        } else if (before) {
+            moves++;
+        } else if (arena.IsAlive(id)) {
+            spawns++;
+        }
+    }
+
+    writer.PutVarint(deaths);
+    int previous = 0;
+    for (int id = 0; id < known; id++) {
+        if (wasAlive[id] && !arena.IsAlive(id)) {
+            writer.PutVarint((uint32_t)(id - previous));
+            previous = id;
+        }
+    }
+
+    writer.PutVarint(moves);
+    uint8_t pending = 0; // Low nibble waiting for its partner
+    uint32_t written = 0;
+    for (int id = 0; id < known; id++) {
+        if (!wasAlive[id] || !arena.IsAlive(id)) {
+            continue;
+        }
+        uint8_t code = (uint8_t)(arena.Direction(id) | (arena.Length(id) > lastLength[id] ? 4 : 0));
+        if (written++ % 2 == 0) {
+            pending = code;
+        } else {
+            out.push_back((uint8_t)(pending | (code << 4)));
+        }
+    }
+    if (written % 2 == 1) {
+        out.push_back(pending);
+    }
+
+    writer.PutVarint(spawns);
+    for (int id = 0; id < count; id++) {
+        if ((id < known && wasAlive[id]) || !arena.IsAlive(id)) {
+            continue;
+        }
+        body.clear();
+        arena.ForEachSegment(id, [&](Cell cell) { body.push_back(cell); });
+        writer.PutVarint((uint32_t)id);
+        writer.Put<uint8_t>((uint8_t)arena.Direction(id));
+        writer.PutVarint((uint32_t)body.size());
+        for (size_t i = body.size(); i-- > 0;) {
+            writer.PutCell(body[i]);
+        }
+    }
+
+    const vector<Cell>& food = arena.FoodSpawned();
+    writer.PutVarint((uint32_t)food.size());
+    for (const Cell& cell : food) {
+        writer.PutCell(cell);
+    }
+
+    Capture(arena);
+}
+
+void ArenaDeltaEncoder::EncodeSnapshot(const Arena& arena, int yourSnake, vector<uint8_t>& out) const {
+    out.clear();
+    NetWriter writer(out);
+    writer.Put<uint16_t>((uint16_t)arena.CellCount());
+    writer.Put<uint32_t>(arena.Tick());
+    writer.Put<int32_t>(yourSnake);
+    writer.PutVarint((uint32_t)arena.SnakeCount());
+    vector<Cell> body;
+    for (int id = 0; id < arena.SnakeCount(); id++) {
+        bool visible = id < (int)wasAlive.size() && arena.IsAlive(id);
+        writer.Put<uint8_t>(visible ? 1 : 0);
+        if (!visible) {
+            continue;
+        }
+        body.clear();
+        arena.ForEachSegment(id, [&](Cell cell) { body.push_back(cell); });
+        writer.Put<uint8_t>((uint8_t)arena.Direction(id));
+        writer.PutVarint((uint32_t)body.size());
+        for (size_t i = body.size(); i-- > 0;) {
+            writer.PutCell(body[i]);
+        }
+    }
+    // The arena keeps no food list, so the snapshot scans the board once per joining client
+    vector<Cell> food;
+    for (int y = 0; y < arena.CellCount(); y++) {
+        for (int x = 0; x < arena.CellCount(); x++) {
+            if (arena.Owner(Cell{x, y}) == ARENA_FOOD) {
+                food.push_back(Cell{x, y});
+            }
+        }
+    }
+    writer.PutVarint((uint32_t)food.size());
+    for (const Cell& cell : food) {
+        writer.PutCell(cell);
+    }
+}
+
+void ArenaMirror::Resize(int count) {
+    if (count > (int)bodies.size()) {
+        bodies.resize(count);
+        direction.resize(count, 0);
+        alive.resize(count, 0);
+    }
+}
+
+bool ArenaMirror::ReadBody(NetReader& reader, int id) {
+    direction[id] = reader.Get<uint8_t>() & 3;
+    uint32_t length = reader.GetVarint();
+    if (!reader.ok || length == 0 || length > (uint32_t)size * size) {
+        return false;
+    }
+    bodies[id].clear();
+    for (uint32_t i = 0; i < length; i++) {
+        Cell cell = reader.GetCell();
+        if (!reader.ok || !OnBoard(cell)) {
+            return false;
+        }
+        bodies[id].push_back(cell);
+        int32_t& value = owner[GridIndex(cell)];
+        if (value == ARENA_FOOD) {
+            foodCount--; // A snake spawned at the start of a tick may eat on its first move
+        }
+        value = id + 1;
+    }
+    alive[id] = 1;
+    return true;
+}
+
+void ArenaMirror::RemoveBody(int id) {
+    for (const Cell& cell : bodies[id]) {
+        owner[GridIndex(cell)] = ARENA_EMPTY;
+    }
+    bodies[id].clear();
+    alive[id] = 0;
+}
+
+bool ArenaMirror::ApplySnapshot(const vector<uint8_t>& payload) {
+    NetReader reader(payload);
+    size = reader.Get<uint16_t>();
+    tick = reader.Get<uint32_t>();
+    yourSnake = reader.Get<int32_t>();
+    uint32_t count = reader.GetVarint();
+    if (!reader.ok || !ValidBoardSize(size) || count > payload.size()) {
+        return false;
+    }
+    stride = size + 2;
+    owner.assign((size_t)stride * stride, ARENA_WALL);
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            owner[GridIndex(Cell{x, y})] = ARENA_EMPTY;
+        }
+    }
+    bodies.clear();
+    direction.clear();
+    alive.clear();
+    Resize((int)count);
+    for (int id = 0; id < (int)count; id++) {
+        if (reader.Get<uint8_t>() && !ReadBody(reader, id)) {
+            return false;
+        }
+    }
+    foodCount = (int)reader.GetVarint();
+    for (int i = 0; i < foodCount && reader.ok; i++) {
+        Cell cell = reader.GetCell();
+        if (!OnBoard(cell)) {
+            return false;
+        }
+        owner[GridIndex(cell)] = ARENA_FOOD;
+    }
+    return reader.ok;
+}
+
+bool ArenaMirror::ApplyTick(const vector<uint8_t>& payload, bool& checksumMatches) {
+    NetReader reader(payload);
+    uint32_t newTick = reader.Get<uint32_t>();
+    uint64_t checksum = reader.Get<uint64_t>();
+    uint32_t count = reader.GetVarint();
+    if (!reader.ok || size == 0 || count < bodies.size() || count > bodies.size() + payload.size()) {
+        return false;
+    }
+    Resize((int)count);
+
+    // Deaths first, so the move codes line up with the snakes still alive
+    uint32_t deaths = reader.GetVarint();
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < deaths && reader.ok; i++) {
+        id += reader.GetVarint();
+        if (id >= count || !alive[id]) {
+            return false;
+        }
+        RemoveBody((int)id);
+    }
+
+    uint32_t moves = reader.GetVarint();
+    movers.clear();
+    for (int snake = 0; snake < (int)count; snake++) {
+        if (alive[snake]) {
+            movers.push_back(snake);
+        }
+    }
+    if (!reader.ok || moves != movers.size()) {
+        return false;
+    }
+    moveCodes.resize(moves);
+    for (uint32_t i = 0; i < moves; i += 2) {
+        uint8_t packed = reader.Get<uint8_t>();
+        moveCodes[i] = packed & 0x0F;
+        if (i + 1 < moves) {
+            moveCodes[i + 1] = packed >> 4;
+        }
+    }
+    if (!reader.ok) {
+        return false;
+    }
+    // Tails leave before heads arrive, as in Arena::Step(), so a head may take a cell a tail left
+    moveFrom.resize(moves);
+    for (uint32_t i = 0; i < moves; i++) {
+        deque<Cell>& body = bodies[movers[i]];
+        moveFrom[i] = body.front();
+        if (!(moveCodes[i] & 4)) {
+            owner[GridIndex(body.back())] = ARENA_EMPTY;
+            body.pop_back();
+        }
+    }
+    for (uint32_t i = 0; i < moves; i++) {
+        int snake = movers[i];
+        deque<Cell>& body = bodies[snake];
+        int dir = moveCodes[i] & 3;
+        Cell head = Cell{moveFrom[i].x + moveDeltas[dir].x, moveFrom[i].y + moveDeltas[dir].y};
+        if (!OnBoard(head)) {
+            return false;
+        }
+        int32_t& cell = owner[GridIndex(head)];
+        if (cell == ARENA_FOOD) {
+            foodCount--;
+        }
+        cell = snake + 1;
+        body.push_front(head);
+        direction[snake] = (uint8_t)dir;
+    }
+
+    uint32_t spawns = reader.GetVarint();
+    for (uint32_t i = 0; i < spawns && reader.ok; i++) {
+        uint32_t snake = reader.GetVarint();
+        if (snake >= count || alive[snake] || !ReadBody(reader, (int)snake)) {
+            return false;
+        }
+    }
+
+    uint32_t food = reader.GetVarint();
+    for (uint32_t i = 0; i < food && reader.ok; i++) {
+        Cell cell = reader.GetCell();
+        if (!OnBoard(cell)) {
+            return false;
+        }
+        owner[GridIndex(cell)] = ARENA_FOOD;
+        foodCount++;
+    }
+    if (!reader.ok) {
+        return false;
+    }
+    tick = newTick;
+    checksumMatches = ArenaChecksum(*this) == checksum;
+    return true;
+}
@@ -0,0 +1,199 @@
+#ifndef ARENA_NET_H
+#define ARENA_NET_H
+
+#include <cstdint>      // Fixed-width integer types of the wire format
+#include <cstring>      // memcpy for unaligned reads
+#include <deque>        // Mirrored snake bodies
+#include <vector>       // Message buffers and per-snake arrays
+
+#include "arena.h"
+
+// Wire format of the arena server (tools/arenaserver.cpp). Messages travel
+// as NetConnection frames; multi-byte fields are little-endian, "varint" is
+// 7 bits per byte with the high bit set on all but the last byte, and a
+// cell is two uint16_t (x, y).
+//
+//   NET_HELLO    client -> server  uint8_t wantsSnake
+//   NET_WELCOME  server -> client  full snapshot, sent once after HELLO:
+//                uint16_t boardSize, uint32_t tick, int32_t yourSnake (-1 for
+//                spectators), varint snakeCount, then per snake uint8_t alive
+//                and, if alive, uint8_t direction, varint length, cells head
+//                first; varint foodCount, food cells
+//   NET_TICK     server -> client  the changes of one step:
+//                uint32_t tick, uint64_t ArenaChecksum, varint snakeCount,
+//                varint deathCount + snake ids (delta coded, ascending),
+//                varint moveCount + one 4-bit code per moving snake (bits 0-1
+//                direction, bit 2 grew), two per byte, for every snake alive
+//                before and after the step in id order,
+//                varint spawnCount + (varint id, uint8_t direction, varint
+//                length, cells head first), varint foodCount + new food cells
+//   NET_INPUT    client -> server  uint32_t tick, uint8_t Input
+//
+// A tick costs half a byte per moving snake plus a few bytes per death,
+// spawn and food item; body lengths never appear except in the snapshot.
+// Eaten food is not sent, a client sees a head move onto it.
+// An INPUT stamped with tick T is applied just before the server plays the
+// step that starts at T, i.e. right after it broadcast the TICK for T.
+
+enum ArenaNetMessage : uint8_t {
+    NET_HELLO   = 1,
+    NET_WELCOME = 2,
+    NET_TICK    = 3,
+    NET_INPUT   = 4
+};
+
+// Appends wire-format fields to a buffer.
+class NetWriter {
+    private:
+        std::vector<uint8_t>& out; // Buffer being appended to
+
+    public:
+        explicit NetWriter(std::vector<uint8_t>& out) : out(out) {}
+
+        // Method to append the raw little-endian bytes of a fixed-width value
+        template <typename T>
+        void Put(T value) {
+            const uint8_t* bytes = (const uint8_t*)&value;
+            out.insert(out.end(), bytes, bytes + sizeof(T));
+        }
+
+        // Appends a varint.
+        void PutVarint(uint32_t value) {
+            while (value >= 0x80) {
+                out.push_back((uint8_t)(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back((uint8_t)value);
+        }
+
+        // Appends a cell.
+        void PutCell(Cell cell) {
+            Put<uint16_t>((uint16_t)cell.x);
+            Put<uint16_t>((uint16_t)cell.y);
+        }
+};
+
+// Reads wire-format fields; any read past the end clears ok and returns zeros.
+class NetReader {
+    private:
+        const uint8_t* position; // Next unread byte
+        const uint8_t* end; // End of the message
+
+    public:
+        bool ok = true; // False once a read ran past the end
+
+        explicit NetReader(const std::vector<uint8_t>& payload) : position(payload.data()), end(payload.data() + payload.size()) {}
+
+        // Method to read a fixed-width little-endian value
+        template <typename T>
+        T Get() {
+            T value = T();
+            if ((size_t)(end - position) < sizeof(T)) {
+                ok = false;
+                return value;
+            }
+            memcpy(&value, position, sizeof(T));
+            position += sizeof(T);
+            return value;
+        }
+
+        // Reads a varint.
+        uint32_t GetVarint() {
+            uint32_t value = 0;
+            for (int shift = 0; shift < 35; shift += 7) {
+                uint8_t byte = Get<uint8_t>();
+                value |= (uint32_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) {
+                    return value;
+                }
+            }
+            ok = false;
+            return 0;
+        }
+
+        // Reads a cell.
+        Cell GetCell() {
+            int x = Get<uint16_t>();
+            int y = Get<uint16_t>();
+            return Cell{x, y};
+        }
+};
+
+// Server side: turns the result of each Arena::Step() into one NET_TICK
+// payload, built once and sent as-is to every client.
+class ArenaDeltaEncoder {
+    private:
+        std::vector<uint8_t> wasAlive; // Per snake, alive after the previous tick
+        std::vector<int32_t> lastLength; // Per snake, length after the previous tick
+        std::vector<Cell> body; // Scratch for spawned bodies
+
+    public:
+        // Remembers the state the next EncodeTick() describes changes from.
+        void Capture(const Arena& arena);
+
+        // Encodes the changes of the step just played into 'out' (replacing it) and captures the new state.
+        void EncodeTick(const Arena& arena, std::vector<uint8_t>& out);
+
+        // Encodes a NET_WELCOME snapshot of the whole arena into 'out' (replacing it). Snakes added
+        // since the last capture are sent as dead, so every client learns of them from the next tick.
+        void EncodeSnapshot(const Arena& arena, int yourSnake, std::vector<uint8_t>& out) const;
+};
+
+// Client side: a copy of the server's arena rebuilt from NET_WELCOME and kept
+// current by NET_TICK messages. Offers the Arena accessors that
+// ArenaChecksum() and ArenaBotPolicy() use.
+class ArenaMirror {
+    private:
+        int size = 0; // Cells along each side
+        int stride = 2; // Row length of the padded grid
+        uint32_t tick = 0; // Steps played on the server
+        int yourSnake = -1; // Snake this client drives, -1 for spectators
+        int foodCount = 0; // Food items on the board
+        std::vector<int32_t> owner; // Padded grid of ArenaCell values or snake id + 1
+        std::vector<std::deque<Cell>> bodies; // Segments per snake, head first
+        std::vector<uint8_t> direction; // Direction of each snake's last move
+        std::vector<uint8_t> alive; // Whether each snake is on the board
+        std::vector<uint8_t> moveCodes; // Scratch: the move codes of one tick
+        std::vector<int> movers; // Scratch: the snakes those codes belong to
+        std::vector<Cell> moveFrom; // Scratch: the heads those snakes move from
+
+        // Returns the grid index of a cell.
+        int GridIndex(Cell cell) const { return (cell.y + 1) * stride + cell.x + 1; }
+
+        // Returns whether a cell lies on the board.
+        bool OnBoard(Cell cell) const { return (unsigned)cell.x < (unsigned)size && (unsigned)cell.y < (unsigned)size; }
+
+        // Grows the per-snake arrays to 'count' snakes.
+        void Resize(int count);
+
+        // Reads a body (head first) and places it on the grid, returns false on bad cells.
+        bool ReadBody(NetReader& reader, int id);
+
+        // Removes a snake's segments from the grid.
+        void RemoveBody(int id);
+
+    public:
+        // Replaces the whole state with a NET_WELCOME snapshot, returns false if it is malformed
+        // (including a board size outside minBoardSize..maxBoardSize, checked before anything is allocated).
+        bool ApplySnapshot(const std::vector<uint8_t>& payload);
+
+        // Applies a NET_TICK, returns false if it is malformed; 'checksumMatches' tells whether the result equals the server's.
+        bool ApplyTick(const std::vector<uint8_t>& payload, bool& checksumMatches);
+
+        int CellCount() const { return size; }
+        uint32_t Tick() const { return tick; }
+        int YourSnake() const { return yourSnake; }
+        int SnakeCount() const { return (int)bodies.size(); }
+        int FoodCount() const { return foodCount; }
+        bool IsAlive(int id) const { return alive[id] != 0; }
+        Cell Head(int id) const { return bodies[id].front(); }
+        int Direction(int id) const { return direction[id]; }
+        int Length(int id) const { return (int)bodies[id].size(); }
+        int32_t Owner(Cell cell) const { return owner[GridIndex(cell)]; }
+        int32_t OwnerAhead(Cell cell, int dir) const {
+            const Cell deltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+            return owner[GridIndex(Cell{cell.x + deltas[dir].x, cell.y + deltas[dir].y})];
+        }
+};
+
+#endif // ARENA_NET_H
@@ -0,0 +1,42 @@
+#ifndef ARENA_POLICY_H
+#define ARENA_POLICY_H
+
+#include "arena.h"
+
+// Scripted arena player for stress tests: takes food next to the head,
+// otherwise keeps going straight while that is safe and now and then turns
+// at random. It only looks at the three cells around the head, so a
+// decision costs the same on any board and with any number of snakes.
+// Works on an Arena or on a client's ArenaMirror.
+template <typename ArenaT>
+Input ArenaBotPolicy(const ArenaT& arena, int id, Rng& rng) {
+    static const Input moves[] = {Input::UP, Input::DOWN, Input::LEFT, Input::RIGHT};
+
+    Cell head = arena.Head(id);
+    int current = arena.Direction(id);
+    int safe[4]; // A length-1 snake may also turn back
+    int safeCount = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        if (dir == (current ^ 1) && arena.Length(id) > 1) {
+            continue; // Arena::Steer refuses reversals anyway
+        }
+        int32_t ahead = arena.OwnerAhead(head, dir);
+        if (ahead == ARENA_FOOD) {
+            return moves[dir];
+        }
+        if (ahead == ARENA_EMPTY) {
+            safe[safeCount++] = dir;
+        }
+    }
+    if (safeCount == 0) {
+        return Input::NONE; // Trapped: keep going and let the arena end the life
+    }
+    for (int i = 0; i < safeCount; i++) {
+        if (safe[i] == current && rng.GetRandomValue(0, 7) != 0) {
+            return moves[current];
+        }
+    }
+    return moves[safe[rng.GetRandomValue(0, safeCount - 1)]];
+}
+
+#endif // ARENA_POLICY_H
@@ -0,0 +1,122 @@
+#include "assets.h"
+
+#include <chrono>       // Steady clock for the load timing report
+#include <cstdio>       // printf for the load timing report
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Returns the seconds elapsed since 'start'.
+static double SecondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+shared_ptr<AssetRegistry> AssetRegistry::Acquire() {
+    // Owners hold strong references; the registry itself only remembers a weak one
+    static weak_ptr<AssetRegistry> shared;
+    shared_ptr<AssetRegistry> registry = shared.lock();
+    if (!registry) {
+        registry = shared_ptr<AssetRegistry>(new AssetRegistry());
+        shared = registry;
+    }
+    return registry;
+}
+
+vector<string> AssetRegistry::FoodAssetNames() {
+    vector<string> names = {"aa", "ab", "ac"};
+    for (char letter = 'a'; letter <= 'z'; ++letter) {
+        names.push_back(string(1, letter));
+    }
+    return names;
+}
+
+AssetRegistry::AssetRegistry()
+    : names(FoodAssetNames()), loaders(0), spriteImages(names.size()), spritesLoaded(0), atlasPacked(false), cancelled(false) {
+    loadStart = chrono::steady_clock::now();
+
+    // Sprites first: the atlas is the only asset the first game frame needs
+    for (size_t i = 0; i < names.size(); i++) {
+        loaders.Submit([this, i] { LoadSprite(i); });
+    }
+    audio.reset(new AudioBank(loaders));
+    wallSound = audio->Add("Sounds/Crash_wall.mp3"); // Queued first: every game ends with it
+    for (const string& name : names) {
+        eatSounds.push_back(audio->Add("Sounds/" + name + ".mp3"));
+    }
+}
+
+void AssetRegistry::LoadSprite(size_t index) {
+    if (!cancelled.load()) {
+        string filename = "Graphics/" + names[index] + ".png";
+        spriteImages[index] = LoadImage(filename.c_str()); // Each task writes only its own slot
+    }
+    if (++spritesLoaded == (int)names.size()) {
+        PackFoodAtlas(); // The last sprite's worker sees every other slot complete
+    }
+}
+
+void AssetRegistry::PackFoodAtlas() {
+    // One GPU texture for every sprite means one texture bind for all food draws
+    int rows = ((int)names.size() + atlasColumns - 1) / atlasColumns;
+    atlasImage = GenImageColor(atlasColumns * atlasSlotSize, rows * atlasSlotSize, BLANK);
+    for (size_t i = 0; i < names.size(); i++) {
+        float slotX = (float)((i % atlasColumns) * atlasSlotSize);
+        float slotY = (float)((i / atlasColumns) * atlasSlotSize);
+        Image& sprite = spriteImages[i];
+        if (sprite.data == nullptr) {
+            // A missing sprite keeps an empty slot, like the failed texture it replaces
+            packedSprites.push_back(Rectangle{slotX, slotY, (float)atlasSlotSize, (float)atlasSlotSize});
+            continue;
+        }
+        Rectangle source = {0, 0, (float)sprite.width, (float)sprite.height};
+        Rectangle slot = {slotX, slotY, (float)sprite.width, (float)sprite.height};
+        ImageDraw(&atlasImage, sprite, source, slot, WHITE);
+        packedSprites.push_back(slot);
+        UnloadImage(sprite);
+        sprite.data = nullptr;
+    }
+    atlasPacked.store(true, memory_order_release); // Publishes atlasImage and packedSprites to Update()
+}
+
+bool AssetRegistry::Update() {
+    if (!atlasUploaded && atlasPacked.load(memory_order_acquire)) {
+        // Only the upload needs the GL context, so only it runs on the main thread
+        foodAtlas = LoadTextureFromImage(atlasImage);
+        UnloadImage(atlasImage);
+        foodSprites = packedSprites;
+        atlasUploaded = true;
+        textureLoadSeconds = SecondsSince(loadStart);
+    }
+    if (soundLoadSeconds == 0 && audio->FinishedCount() == audio->Count()) {
+        soundLoadSeconds = SecondsSince(loadStart);
+    }
+    return IsReady();
+}
+
+float AssetRegistry::Progress() const {
+    int total = (int)names.size() + 1 + audio->Count(); // Sprites, the atlas upload, sounds
+    int done = spritesLoaded.load() + (atlasUploaded ? 1 : 0) + audio->FinishedCount();
+    return (float)done / total;
+}
+
+AssetRegistry::~AssetRegistry() {
+    cancelled.store(true);
+    audio.reset(); // Stops the mixer before the audio device closes, and waits for the loaders
+    loaders.Wait();
+    if (atlasUploaded) {
+        UnloadTexture(foodAtlas);
+    } else if (atlasPacked.load()) {
+        UnloadImage(atlasImage);
+    } else {
+        for (const Image& sprite : spriteImages) {
+            if (sprite.data != nullptr) {
+                UnloadImage(sprite);
+            }
+        }
+    }
+}
+
+void AssetRegistry::PrintLoadReport() const {
+    printf("Asset loading on %u workers: %d sprites on the GPU after %.1f ms, %d of %d sounds decoded after %.1f ms (%.1f ms of decoding)\n",
+           loaders.Size(), (int)foodSprites.size(), textureLoadSeconds * 1000.0,
+           audio->ReadyCount(), audio->Count(), soundLoadSeconds * 1000.0, audio->DecodeMilliseconds());
+}
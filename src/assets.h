@@ -0,0 +1,78 @@
+#ifndef ASSETS_H
+#define ASSETS_H
+
+#include <raylib.h>     // Texture2D and Image handles
+#include <atomic>       // Progress counters shared with the loading workers
+#include <chrono>       // Start of loading, for the report
+#include <memory>       // std::shared_ptr for the shared registry
+#include <string>       // File name stems
+#include <vector>       // The vector containers holding the handles
+
+#include "audio_bank.h"
+#include "thread_pool.h"
+
+// Every texture and sound the game uses, loaded once and shared by everyone
+// who needs them. Handles are unloaded exactly once, when the last owner
+// releases its reference; the registry cannot be copied.
+// Loading is asynchronous: files are read and decoded on a worker pool while
+// the game keeps drawing, and only the GPU upload runs on the main thread,
+// in Update(). Until IsReady(), foodSprites is empty and sounds may be skipped.
+class AssetRegistry {
+    public:
+        Texture2D foodAtlas; // All letter sprites packed into a single texture, valid once IsReady()
+        std::vector<Rectangle> foodSprites; // Source rectangle of each food variant inside foodAtlas
+        std::unique_ptr<AudioBank> audio; // Every sound, decoded in the background and mixed on a voice pool
+        std::vector<int> eatSounds; // Clip id of one eating sound per food variant
+        int wallSound; // Clip id of the sound effect for when the snake hits a wall.
+        double textureLoadSeconds = 0; // Time until the sprite atlas was on the GPU
+        double soundLoadSeconds = 0; // Time until the last sound was decoded
+
+        // Returns the shared registry, starting to load it on the first call (needs a window and an audio device).
+        static std::shared_ptr<AssetRegistry> Acquire();
+
+        // Returns the file name stems shared by Graphics/*.png and Sounds/*.mp3.
+        static std::vector<std::string> FoodAssetNames();
+
+        // Returns the number of food variants (known before loading finishes).
+        int FoodVariantCount() const { return (int)names.size(); }
+
+        // Finishes whatever the workers have prepared (GPU upload); call once per frame on the main thread.
+        // Returns whether every asset is loaded.
+        bool Update();
+
+        // Returns whether every asset is loaded.
+        bool IsReady() const { return atlasUploaded && audio->FinishedCount() == audio->Count(); }
+
+        // Returns the fraction of files loaded, from 0 to 1.
+        float Progress() const;
+
+        // Prints how long loading took.
+        void PrintLoadReport() const;
+
+        ~AssetRegistry();
+        AssetRegistry(const AssetRegistry&) = delete;
+        AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+    private:
+        static const int atlasSlotSize = 30; // Every letter sprite fits in a 30x30 slot
+        static const int atlasColumns = 8; // Slots per atlas row
+
+        std::vector<std::string> names; // Food variants, see FoodAssetNames()
+        ThreadPool loaders; // Reads and decodes images and sounds
+        std::vector<Image> spriteImages; // Decoded sprites, one slot per worker task
+        std::atomic<int> spritesLoaded; // Sprites decoded so far
+        Image atlasImage; // Packed atlas waiting for upload
+        std::vector<Rectangle> packedSprites; // Source rectangles matching atlasImage
+        std::atomic<bool> atlasPacked; // Set by the worker that packed atlasImage
+        std::atomic<bool> cancelled; // Set on destruction, skips work still queued
+        bool atlasUploaded = false; // Whether foodAtlas is valid
+        std::chrono::steady_clock::time_point loadStart; // When loading began
+
+        AssetRegistry();
+        // Decodes one sprite on a worker; the last one to finish packs the atlas.
+        void LoadSprite(size_t index);
+        // Packs every decoded sprite into atlasImage (CPU only, runs on a worker).
+        void PackFoodAtlas();
+};
+
+#endif // ASSETS_H
@@ -0,0 +1,142 @@
+#include "audio_bank.h"
+
+#include <chrono>       // Decode timing
+#include <cstdio>       // printf for decode errors
+#include <cstring>      // memset for silence
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// The bank feeding the stream; raylib's callback has no user data
+static atomic<AudioBank*> activeBank(nullptr);
+
+AudioBank::AudioBank(ThreadPool& decoder) : cancelled(false), decodeMicroseconds(0), decoder(decoder) {
+    SetAudioStreamBufferSizeDefault(1024); // About 23 ms of latency at 44.1 kHz
+    stream = LoadAudioStream(sampleRate, 16, channels);
+    activeBank.store(this);
+    SetAudioStreamCallback(stream, StreamCallback);
+    PlayAudioStream(stream);
+}
+
+AudioBank::~AudioBank() {
+    StopAudioStream(stream);
+    UnloadAudioStream(stream); // No callback runs after this
+    activeBank.store(nullptr);
+    cancelled.store(true);
+    decoder.Wait(); // Only decodes already running remain
+}
+
+int AudioBank::Add(const string& path) {
+    clips.emplace_back(new Clip(path));
+    Clip* clip = clips.back().get(); // Workers hold the clip itself; the vector may grow meanwhile
+    decoder.Submit([this, clip] { Decode(*clip); });
+    return (int)clips.size() - 1;
+}
+
+void AudioBank::Decode(Clip& clip) {
+    int expected = CLIP_QUEUED;
+    if (cancelled.load() || !clip.state.compare_exchange_strong(expected, CLIP_DECODING)) {
+        return; // Shutting down, or another task got there first
+    }
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    Wave wave = LoadWave(clip.path.c_str());
+    if (wave.data == nullptr || wave.frameCount == 0) {
+        printf("Error loading sound file %s.\n", clip.path.c_str());
+        clip.state.store(CLIP_FAILED, memory_order_release);
+        return;
+    }
+    WaveFormat(&wave, sampleRate, 16, channels);
+    const int16_t* pcm = (const int16_t*)wave.data;
+    clip.samples.assign(pcm, pcm + (size_t)wave.frameCount * channels);
+    UnloadWave(wave);
+    decodeMicroseconds += (long)chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+    clip.state.store(CLIP_READY, memory_order_release); // Publishes the samples to the mixer
+}
+
+void AudioBank::Play(int id) {
+    if (id < 0 || id >= (int)clips.size()) {
+        return;
+    }
+    Clip* clip = clips[id].get();
+    int state = clip->state.load(memory_order_acquire);
+    if (state == CLIP_READY) {
+        requests.TryPush(clip); // A full queue means 64 sounds this callback period; dropping one is fine
+    } else if (state == CLIP_QUEUED) {
+        // Wanted now: decode it ahead of the clips still waiting in the queue
+        decoder.Submit([this, clip] { Decode(*clip); });
+    }
+}
+
+int AudioBank::ReadyCount() const {
+    int ready = 0;
+    for (const unique_ptr<Clip>& clip : clips) {
+        ready += clip->state.load() == CLIP_READY ? 1 : 0;
+    }
+    return ready;
+}
+
+int AudioBank::FinishedCount() const {
+    int finished = 0;
+    for (const unique_ptr<Clip>& clip : clips) {
+        int state = clip->state.load();
+        finished += (state == CLIP_READY || state == CLIP_FAILED) ? 1 : 0;
+    }
+    return finished;
+}
+
+void AudioBank::StreamCallback(void* buffer, unsigned int frames) {
+    AudioBank* bank = activeBank.load();
+    if (bank != nullptr) {
+        bank->Mix((int16_t*)buffer, frames);
+    } else {
+        memset(buffer, 0, (size_t)frames * channels * sizeof(int16_t));
+    }
+}
+
+void AudioBank::Mix(int16_t* output, unsigned frames) {
+    // Start the requested clips; with every voice busy, restart the one that has played longest
+    const Clip* clip;
+    while (requests.TryPop(clip)) {
+        Voice* target = &voices[0];
+        for (Voice& voice : voices) {
+            if (voice.clip == nullptr) {
+                target = &voice;
+                break;
+            }
+            if (voice.position > target->position) {
+                target = &voice;
+            }
+        }
+        target->clip = clip;
+        target->position = 0;
+    }
+
+    // Sum the voices in 32 bits, then saturate to 16
+    const unsigned chunkFrames = 256;
+    int32_t mix[chunkFrames * channels];
+    for (unsigned done = 0; done < frames; done += chunkFrames) {
+        unsigned count = frames - done < chunkFrames ? frames - done : chunkFrames;
+        size_t sampleCount = (size_t)count * channels;
+        memset(mix, 0, sampleCount * sizeof(int32_t));
+        for (Voice& voice : voices) {
+            if (voice.clip == nullptr) {
+                continue;
+            }
+            const vector<int16_t>& samples = voice.clip->samples;
+            size_t available = samples.size() - voice.position;
+            size_t take = available < sampleCount ? available : sampleCount;
+            const int16_t* source = samples.data() + voice.position;
+            for (size_t i = 0; i < take; i++) {
+                mix[i] += source[i];
+            }
+            voice.position += take;
+            if (voice.position >= samples.size()) {
+                voice.clip = nullptr; // Finished, the voice is free again
+            }
+        }
+        int16_t* out = output + (size_t)done * channels;
+        for (size_t i = 0; i < sampleCount; i++) {
+            int32_t value = mix[i];
+            out[i] = (int16_t)(value > 32767 ? 32767 : (value < -32768 ? -32768 : value));
+        }
+    }
+}
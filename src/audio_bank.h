@@ -0,0 +1,88 @@
+#ifndef AUDIO_BANK_H
+#define AUDIO_BANK_H
+
+#include <raylib.h>     // AudioStream and Wave decoding
+#include <atomic>       // Clip states shared with the decoder and the mixer
+#include <cstdint>      // 16-bit PCM samples
+#include <memory>       // std::unique_ptr for the clips
+#include <string>       // Clip file names
+#include <vector>       // Clips and their samples
+
+#include "spsc_queue.h"
+#include "thread_pool.h"
+
+// Sound clips decoded off the main thread and mixed by a small voice pool.
+// Clips are decoded to 44.1 kHz 16-bit stereo PCM on a worker pool right
+// after they are added, so startup never waits on MP3 decoding; a clip asked
+// to play before it is ready is decoded next and the request is skipped.
+// Playing a clip takes a free voice (or the one that has played longest), so
+// overlapping sounds mix instead of cutting each other off. The render thread
+// hands play requests to the audio callback through a lock-free queue.
+// Needs an initialized audio device; must be destroyed before CloseAudioDevice().
+class AudioBank {
+    public:
+        static const int sampleRate = 44100; // Mixer output rate
+        static const int channels = 2; // Mixer output is stereo
+        static const int voiceCount = 8; // Sounds that can play at once
+
+    private:
+        enum ClipState { CLIP_QUEUED, CLIP_DECODING, CLIP_READY, CLIP_FAILED };
+
+        // One decoded sound.
+        struct Clip {
+            std::string path; // Source file
+            std::atomic<int> state; // ClipState; samples are complete once CLIP_READY
+            std::vector<int16_t> samples; // Interleaved stereo PCM
+            Clip(const std::string& path) : path(path), state(CLIP_QUEUED) {}
+        };
+
+        // One sound being mixed, owned by the audio callback.
+        struct Voice {
+            const Clip* clip = nullptr; // Playing clip, null when free
+            size_t position = 0; // Next sample to mix
+        };
+
+        std::vector<std::unique_ptr<Clip>> clips; // Every added clip; only the thread calling Add() touches the vector
+        SpscQueue<const Clip*, 64> requests; // Clips to start, from the render thread to the callback
+        Voice voices[voiceCount]; // Voice pool, audio thread only
+        AudioStream stream; // Stream fed by Mix()
+        std::atomic<bool> cancelled; // Set on destruction, skips decodes still queued
+        std::atomic<long> decodeMicroseconds; // Total time spent decoding
+        ThreadPool& decoder; // Workers running the decodes, shared with other loaders
+
+        // Decodes a clip on a worker thread.
+        void Decode(Clip& clip);
+        // Mixes the active voices into the stream buffer; runs on the audio thread.
+        void Mix(int16_t* output, unsigned frames);
+        // Trampoline for raylib's callback, which carries no user pointer.
+        static void StreamCallback(void* buffer, unsigned int frames);
+
+    public:
+        // Decodes on 'decoder', which must outlive the bank.
+        explicit AudioBank(ThreadPool& decoder);
+        // Skips the decodes still queued and waits for the running ones (and the pool's other tasks).
+        ~AudioBank();
+
+        AudioBank(const AudioBank&) = delete;
+        AudioBank& operator=(const AudioBank&) = delete;
+
+        // Adds a clip and queues it for background decoding, returns its id.
+        int Add(const std::string& path);
+
+        // Starts a clip on a voice; skipped (and decoded next) if it is not decoded yet.
+        void Play(int clip);
+
+        // Returns the number of clips decoded so far.
+        int ReadyCount() const;
+
+        // Returns the number of clips whose decoding finished, successfully or not.
+        int FinishedCount() const;
+
+        // Returns the number of clips added.
+        int Count() const { return (int)clips.size(); }
+
+        // Returns the total decoding time so far, in milliseconds.
+        double DecodeMilliseconds() const { return decodeMicroseconds.load() / 1000.0; }
+};
+
+#endif // AUDIO_BANK_H
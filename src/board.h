@@ -0,0 +1,80 @@
+#ifndef BOARD_H
+#define BOARD_H
+
+#include "cell.h"
+
+// Side lengths a run-time board may have: the starting snake needs 10 cells,
+// and 4096 keeps every cell index and packed coordinate in range.
+const int minBoardSize = 10;
+const int maxBoardSize = 4096;
+
+// Returns whether a run-time side length is supported.
+inline bool ValidBoardSize(int cellCount) {
+    return cellCount >= minBoardSize && cellCount <= maxBoardSize;
+}
+
+// Board geometry known at compile time. Every member is constexpr, so bounds
+// checks, index math and loop trip counts fold into immediates in the
+// simulation code instantiated for this size.
+template <int N>
+struct Board {
+    static_assert(N >= minBoardSize && N <= maxBoardSize, "the board must have 10 to 4096 cells along each side");
+
+    // Returns the number of cells along each side.
+    static constexpr int CellCount() { return N; }
+
+    // Returns the total number of cells.
+    static constexpr int Area() { return N * N; }
+
+    // Returns whether the cell lies on the board.
+    static constexpr bool Contains(Cell cell) {
+        return (unsigned)cell.x < (unsigned)N && (unsigned)cell.y < (unsigned)N;
+    }
+
+    // Returns the row-major index of an on-board cell.
+    static constexpr int Index(Cell cell) { return cell.y * N + cell.x; }
+
+    // Returns the cell at a row-major index.
+    static constexpr Cell CellAt(int index) { return Cell{index % N, index / N}; }
+};
+
+// Board geometry chosen at run time, for sizes without a compiled specialization.
+// Same interface as Board<N>, with the side length stored in the object.
+class DynamicBoard {
+    private:
+        int size; // Number of cells along each side, see ValidBoardSize()
+
+    public:
+        // Only WithBoard() creates these, after checking the size.
+        explicit DynamicBoard(int size) : size(size) {}
+
+        int CellCount() const { return size; }
+        int Area() const { return size * size; }
+        bool Contains(Cell cell) const {
+            return (unsigned)cell.x < (unsigned)size && (unsigned)cell.y < (unsigned)size;
+        }
+        int Index(Cell cell) const { return cell.y * size + cell.x; }
+        Cell CellAt(int index) const { return Cell{index % size, index / size}; }
+};
+
+// The classic 29x29 board drawn by the windowed game.
+typedef Board<29> DefaultBoard;
+
+// Calls visit(board) with the fastest board type for a run-time side length:
+// one of the compiled specializations when it matches, DynamicBoard otherwise.
+// Returns false, without calling visit, for a size ValidBoardSize() rejects.
+template <typename Visitor>
+bool WithBoard(int cellCount, Visitor&& visit) {
+    if (!ValidBoardSize(cellCount)) {
+        return false;
+    }
+    switch (cellCount) {
+        case 29:  visit(Board<29>()); break;
+        case 64:  visit(Board<64>()); break;
+        case 256: visit(Board<256>()); break;
+        default:  visit(DynamicBoard(cellCount)); break;
+    }
+    return true;
+}
+
+#endif // BOARD_H
@@ -0,0 +1,13 @@
+#ifndef CELL_H
+#define CELL_H
+
+// Integer coordinates of a single board cell
+struct Cell {
+    int x;
+    int y;
+};
+
+inline bool operator==(Cell a, Cell b) { return a.x == b.x && a.y == b.y; }
+inline bool operator!=(Cell a, Cell b) { return !(a == b); }
+
+#endif // CELL_H
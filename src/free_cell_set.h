@@ -0,0 +1,70 @@
+#ifndef FREE_CELL_SET_H
+#define FREE_CELL_SET_H
+
+#include <vector>       // The vector containers backing the set
+
+// Indexable set of cell indices with O(1) insert, erase and random access.
+// Members live densely in 'cells'; 'slots' maps a cell index to its position
+// there (or -1), so erasing swaps the last member into the hole.
+class FreeCellSet {
+    private:
+        std::vector<int> cells; // Dense list of members, in no particular order
+        std::vector<int> slots; // Position of each cell index inside 'cells', -1 if absent
+
+    public:
+        explicit FreeCellSet(int universe) : slots(universe, -1) {
+            cells.reserve(universe); // Never reallocates while the game runs
+        }
+
+        // Returns the number of members.
+        int Size() const { return (int)cells.size(); }
+
+        // Returns whether the set has no members.
+        bool Empty() const { return cells.empty(); }
+
+        // Returns the member stored at a dense position in [0, Size()).
+        int At(int slot) const { return cells[slot]; }
+
+        // Returns whether a cell index is a member.
+        bool Contains(int index) const { return slots[index] >= 0; }
+
+        // Adds a cell index, ignoring duplicates.
+        void Insert(int index) {
+            if (slots[index] >= 0) {
+                return;
+            }
+            slots[index] = (int)cells.size();
+            cells.push_back(index);
+        }
+
+        // Removes a cell index by moving the last member into its slot.
+        void Erase(int index) {
+            int slot = slots[index];
+            if (slot < 0) {
+                return;
+            }
+            int last = cells.back();
+            cells[slot] = last;
+            slots[last] = slot;
+            cells.pop_back();
+            slots[index] = -1;
+        }
+
+        // Replaces the members with 'count' indices, keeping their order (positions decide random picks).
+        void Assign(const int* indices, int count) {
+            Clear();
+            for (int i = 0; i < count; i++) {
+                Insert(indices[i]);
+            }
+        }
+
+        // Removes every member.
+        void Clear() {
+            for (int index : cells) {
+                slots[index] = -1;
+            }
+            cells.clear();
+        }
+};
+
+#endif // FREE_CELL_SET_H
@@ -0,0 +1,50 @@
+#ifndef GREEDY_POLICY_H
+#define GREEDY_POLICY_H
+
+#include <climits>      // INT_MAX as the starting best distance
+#include <cstdlib>      // std::abs for Manhattan distances
+
+#include "simulation.h"
+
+// Scripted player for self-play: among the moves that do not hit a wall or
+// the body this tick, takes the one that ends closest to the food
+// (Manhattan distance, ties broken in UP, DOWN, LEFT, RIGHT order).
+// It looks one move ahead only, so it eventually traps itself; that is
+// intended, it is a baseline for tuning, not a solver.
+template <typename BoardT>
+Input GreedyPolicy(const BasicSimulation<BoardT>& sim) {
+    static const Input moves[] = {Input::UP, Input::DOWN, Input::LEFT, Input::RIGHT};
+    static const Cell deltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+
+    const Snake<BoardT>& snake = sim.snake;
+    Cell head = snake.body[0];
+    Cell tail = snake.body.back();
+    Input best = Input::NONE;
+    int bestDistance = INT_MAX;
+    for (int i = 0; i < 4; i++) {
+        if (deltas[i].x == -snake.direction.x && deltas[i].y == -snake.direction.y) {
+            continue; // The simulation refuses reversals anyway
+        }
+        Cell next = Cell{head.x + deltas[i].x, head.y + deltas[i].y};
+        if (!snake.occupancy.Contains(next)) {
+            continue;
+        }
+        // The tail cell is free next tick unless the snake is growing
+        bool tailMoves = next == tail && !snake.addSegment;
+        if (snake.occupancy.IsOccupied(next) && !tailMoves) {
+            continue;
+        }
+        int distance = 0;
+        if (sim.food.placed) {
+            distance = std::abs(next.x - sim.food.position.x) + std::abs(next.y - sim.food.position.y);
+        }
+        if (distance < bestDistance) {
+            bestDistance = distance;
+            best = moves[i];
+        }
+    }
+    // With no safe move, keep going and let the simulation end the run
+    return best;
+}
+
+#endif // GREEDY_POLICY_H
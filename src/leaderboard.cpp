@@ -0,0 +1,278 @@
+#include "leaderboard.h"
+
+#include <cstring>      // memcpy/memcmp for the packed layouts
+#include <iterator>     // std::prev for the worst entry of a list
+
+#include "mapped_file.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// First bytes of the log, followed by the records
+struct LeaderboardLogHeader {
+    char magic[4]; // "SNKL"
+    uint16_t version;
+    uint16_t recordSize; // sizeof(LeaderboardRecord)
+    uint64_t reserved;
+};
+static_assert(sizeof(LeaderboardLogHeader) == 16, "LeaderboardLogHeader layout is part of the file format");
+
+// First bytes of the index, followed per level by a uint32 count, a uint32
+// pad and 'count' pairs of LeaderboardRecord and uint64 log position
+struct LeaderboardIndexHeader {
+    char magic[4]; // "SNKI"
+    uint16_t version;
+    uint16_t capacity; // Entries kept per level when the index was written
+    uint32_t levels; // leaderboardLevels
+    uint32_t reserved;
+    uint64_t logRecords; // Log records the index accounts for
+};
+static_assert(sizeof(LeaderboardIndexHeader) == 24, "LeaderboardIndexHeader layout is part of the file format");
+
+static const uint16_t leaderboardVersion = 1;
+
+// Function to return the size of a file, or -1 if it cannot be opened
+static int64_t FileSize(const string& path) {
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    int64_t size = ftell(file);
+    fclose(file);
+    return size;
+}
+
+// Function to turn a stored record into a query row
+static LeaderboardEntry ToEntry(const LeaderboardRecord& record, uint64_t position) {
+    LeaderboardEntry entry;
+    entry.name.assign(record.name, record.nameLength < sizeof(record.name) ? record.nameLength : sizeof(record.name));
+    entry.score = record.score;
+    entry.level = (SpeedLevel)record.level;
+    entry.time = record.time;
+    entry.record = position;
+    return entry;
+}
+
+// Function to turn a query row back into a stored record
+static LeaderboardRecord ToRecord(const LeaderboardEntry& entry) {
+    LeaderboardRecord record;
+    memset(&record, 0, sizeof(record));
+    record.time = entry.time;
+    record.score = entry.score;
+    record.level = (uint8_t)entry.level;
+    record.nameLength = (uint8_t)(entry.name.size() < sizeof(record.name) ? entry.name.size() : sizeof(record.name));
+    memcpy(record.name, entry.name.data(), record.nameLength);
+    record.commit = leaderboardCommit;
+    return record;
+}
+
+bool Leaderboard::Open(const string& logPath, const string& indexPath) {
+    Close();
+    this->logPath = logPath;
+    this->indexPath = indexPath;
+    for (auto& list : top) {
+        list.clear();
+    }
+    rebuilt = false;
+
+    int64_t size = FileSize(logPath);
+    if (size < 0) {
+        // No log yet: start an empty one
+        LeaderboardLogHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, "SNKL", 4);
+        header.version = leaderboardVersion;
+        header.recordSize = sizeof(LeaderboardRecord);
+        FILE* file = fopen(logPath.c_str(), "wb");
+        if (file == nullptr || fwrite(&header, sizeof(header), 1, file) != 1) {
+            if (file != nullptr) {
+                fclose(file);
+            }
+            return false;
+        }
+        fclose(file);
+        size = sizeof(header);
+    } else {
+        LeaderboardLogHeader header;
+        FILE* file = fopen(logPath.c_str(), "rb");
+        bool valid = file != nullptr && size >= (int64_t)sizeof(header) && fread(&header, sizeof(header), 1, file) == 1 &&
+                     memcmp(header.magic, "SNKL", 4) == 0 && header.version == leaderboardVersion &&
+                     header.recordSize == sizeof(LeaderboardRecord);
+        if (file != nullptr) {
+            fclose(file);
+        }
+        if (!valid) {
+            return false; // Not ours, or too short to be; never overwrite it
+        }
+    }
+
+    log = fopen(logPath.c_str(), "ab");
+    if (log == nullptr) {
+        return false;
+    }
+    // Complete a record torn by a crash with zeros, so later appends stay aligned; it has no commit byte
+    uint64_t bodySize = (uint64_t)size - sizeof(LeaderboardLogHeader);
+    size_t torn = (size_t)(bodySize % sizeof(LeaderboardRecord));
+    if (torn != 0) {
+        static const char zeros[sizeof(LeaderboardRecord)] = {};
+        fwrite(zeros, 1, sizeof(LeaderboardRecord) - torn, log);
+        fflush(log);
+        bodySize += sizeof(LeaderboardRecord) - torn;
+    }
+    recordCount = bodySize / sizeof(LeaderboardRecord);
+
+    int64_t covered = ReadIndex();
+    if (covered < 0 || (uint64_t)covered > recordCount) {
+        for (auto& list : top) {
+            list.clear();
+        }
+        covered = 0;
+        rebuilt = true;
+    }
+    if ((uint64_t)covered < recordCount) {
+        if (!ReadLog((uint64_t)covered)) {
+            return false;
+        }
+        WriteIndex();
+    }
+    return true;
+}
+
+void Leaderboard::Close() {
+    if (log != nullptr) {
+        fclose(log);
+        log = nullptr;
+    }
+}
+
+bool Leaderboard::Add(const string& name, int score, SpeedLevel level, int64_t time) {
+    if (log == nullptr) {
+        return false;
+    }
+    LeaderboardEntry entry;
+    entry.name = name;
+    entry.score = score;
+    entry.level = level;
+    entry.time = time;
+    entry.record = recordCount;
+    LeaderboardRecord record = ToRecord(entry);
+    if (fwrite(&record, sizeof(record), 1, log) != 1 || fflush(log) != 0) {
+        return false;
+    }
+    recordCount++;
+    Insert(entry);
+    return WriteIndex();
+}
+
+vector<LeaderboardEntry> Leaderboard::Top(SpeedLevel level, int count) const {
+    vector<LeaderboardEntry> result;
+    for (const LeaderboardEntry& entry : top[(int)level]) {
+        if ((int)result.size() >= count) {
+            break;
+        }
+        result.push_back(entry);
+    }
+    return result;
+}
+
+void Leaderboard::Insert(const LeaderboardEntry& entry) {
+    set<LeaderboardEntry, Better>& list = top[(int)entry.level];
+    if ((int)list.size() >= capacity) {
+        auto worst = prev(list.end());
+        if (!Better()(entry, *worst)) {
+            return; // Does not make the list
+        }
+        list.erase(worst);
+    }
+    list.insert(entry);
+}
+
+bool Leaderboard::ReadLog(uint64_t first) {
+    MappedFile file;
+    if (!file.Open(logPath)) {
+        return false;
+    }
+    const unsigned char* records = file.Data() + sizeof(LeaderboardLogHeader);
+    uint64_t available = (file.Size() - sizeof(LeaderboardLogHeader)) / sizeof(LeaderboardRecord);
+    uint64_t last = available < recordCount ? available : recordCount;
+    int worst[leaderboardLevels]; // Score a game must beat to enter a full list
+    for (int level = 0; level < leaderboardLevels; level++) {
+        worst[level] = (int)top[level].size() >= capacity ? prev(top[level].end())->score : INT32_MIN;
+    }
+    for (uint64_t i = first; i < last; i++) {
+        LeaderboardRecord record;
+        memcpy(&record, records + i * sizeof(LeaderboardRecord), sizeof(record));
+        if (record.commit != leaderboardCommit || record.level >= leaderboardLevels) {
+            continue; // Torn or damaged record
+        }
+        // Cheap pre-check, so only contenders pay for building a name string
+        if (record.score <= worst[record.level]) {
+            continue;
+        }
+        Insert(ToEntry(record, i));
+        if ((int)top[record.level].size() >= capacity) {
+            worst[record.level] = prev(top[record.level].end())->score;
+        }
+    }
+    return true;
+}
+
+int64_t Leaderboard::ReadIndex() {
+    FILE* file = fopen(indexPath.c_str(), "rb");
+    if (file == nullptr) {
+        return -1;
+    }
+    LeaderboardIndexHeader header;
+    bool valid = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.magic, "SNKI", 4) == 0 &&
+                 header.version == leaderboardVersion && header.capacity == capacity &&
+                 header.levels == leaderboardLevels;
+    for (int level = 0; valid && level < leaderboardLevels; level++) {
+        uint32_t count[2]; // Count and pad
+        valid = fread(count, sizeof(count), 1, file) == 1 && count[0] <= (uint32_t)capacity;
+        for (uint32_t i = 0; valid && i < count[0]; i++) {
+            LeaderboardRecord record;
+            uint64_t position;
+            valid = fread(&record, sizeof(record), 1, file) == 1 && fread(&position, sizeof(position), 1, file) == 1 &&
+                    record.commit == leaderboardCommit && record.level == level;
+            if (valid) {
+                top[level].insert(ToEntry(record, position));
+            }
+        }
+    }
+    fclose(file);
+    return valid ? (int64_t)header.logRecords : -1;
+}
+
+bool Leaderboard::WriteIndex() const {
+    LeaderboardIndexHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SNKI", 4);
+    header.version = leaderboardVersion;
+    header.capacity = (uint16_t)capacity;
+    header.levels = leaderboardLevels;
+    header.logRecords = recordCount;
+
+    // Write a temporary file and swap it in; a crash in between only costs a rebuild
+    string temporaryPath = indexPath + ".tmp";
+    FILE* file = fopen(temporaryPath.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (int level = 0; written && level < leaderboardLevels; level++) {
+        uint32_t count[2] = {(uint32_t)top[level].size(), 0};
+        written = fwrite(count, sizeof(count), 1, file) == 1;
+        for (const LeaderboardEntry& entry : top[level]) {
+            LeaderboardRecord record = ToRecord(entry);
+            written = written && fwrite(&record, sizeof(record), 1, file) == 1 &&
+                      fwrite(&entry.record, sizeof(entry.record), 1, file) == 1;
+        }
+    }
+    written = fclose(file) == 0 && written;
+    if (!written) {
+        remove(temporaryPath.c_str());
+        return false;
+    }
+    remove(indexPath.c_str()); // rename() does not replace files on Windows
+    return rename(temporaryPath.c_str(), indexPath.c_str()) == 0;
+}
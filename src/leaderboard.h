@@ -0,0 +1,97 @@
+#ifndef LEADERBOARD_H
+#define LEADERBOARD_H
+
+#include <cstdint>      // Fixed-width fields of the file formats
+#include <cstdio>       // FILE handle of the open log
+#include <set>          // Ordered top-K of each speed level
+#include <string>       // Player names and paths
+#include <vector>       // Query results
+
+#include "simulation.h"
+
+// One finished game as stored in the log. The last byte is written last, so a
+// record torn by a crash (commit != leaderboardCommit) is skipped on load.
+struct LeaderboardRecord {
+    int64_t time; // Unix time the game ended
+    int32_t score; // Final score
+    uint8_t level; // SpeedLevel of the run
+    uint8_t nameLength; // Bytes used in 'name'
+    char name[33]; // Player name, truncated, not null-terminated
+    uint8_t commit; // leaderboardCommit once the record is complete
+};
+static_assert(sizeof(LeaderboardRecord) == 48, "LeaderboardRecord layout is part of the file format");
+
+const uint8_t leaderboardCommit = 0xA5;
+const int leaderboardLevels = 4; // One top list per SpeedLevel
+const int defaultLeaderboardCapacity = 100; // Entries kept per speed level
+
+// A leaderboard row as returned by queries
+struct LeaderboardEntry {
+    std::string name; // Player name
+    int score; // Final score
+    SpeedLevel level; // Speed level of the run
+    int64_t time; // Unix time the game ended
+    uint64_t record; // Position of the game in the log
+};
+
+// Persistent leaderboard made of two files:
+//   the log    every finished game, appended as a fixed-size record; never rewritten
+//   the index  the best 'capacity' games of each speed level plus the number of
+//              log records it covers; rewritten (a few KB) after every game
+// Opening reads the index and only the log records added after it was written,
+// so startup stays constant-time however many games have been played. A missing
+// or damaged index is rebuilt with one sequential pass over the memory-mapped log.
+class Leaderboard {
+    private:
+        // Orders entries best first: higher score, then the earlier game.
+        struct Better {
+            bool operator()(const LeaderboardEntry& a, const LeaderboardEntry& b) const {
+                return a.score != b.score ? a.score > b.score : a.record < b.record;
+            }
+        };
+
+        int capacity; // Entries kept per speed level
+        std::set<LeaderboardEntry, Better> top[leaderboardLevels]; // Best games of each level, O(log K) inserts
+        std::string logPath; // Append-only game log
+        std::string indexPath; // Top-K snapshot
+        FILE* log = nullptr; // Log opened for appending
+        uint64_t recordCount = 0; // Complete records in the log
+        bool rebuilt = false; // True if Open() had to scan the whole log
+
+        // Offers a game to its level's top list.
+        void Insert(const LeaderboardEntry& entry);
+        // Scans log records [first, recordCount) into the top lists.
+        bool ReadLog(uint64_t first);
+        // Loads the top lists from the index, returns the number of log records it covers, or -1.
+        int64_t ReadIndex();
+        // Writes the top lists to the index.
+        bool WriteIndex() const;
+
+    public:
+        explicit Leaderboard(int capacity = defaultLeaderboardCapacity) : capacity(capacity) {}
+        ~Leaderboard() { Close(); }
+
+        Leaderboard(const Leaderboard&) = delete;
+        Leaderboard& operator=(const Leaderboard&) = delete;
+
+        // Opens the two files, creating a missing log; returns false if the log cannot be used
+        // (including an existing file too short for the header, which is left untouched).
+        bool Open(const std::string& logPath, const std::string& indexPath);
+
+        // Closes the log.
+        void Close();
+
+        // Appends a finished game to the log and the top lists, returns false on I/O errors.
+        bool Add(const std::string& name, int score, SpeedLevel level, int64_t time);
+
+        // Returns up to 'count' best games of a speed level, best first.
+        std::vector<LeaderboardEntry> Top(SpeedLevel level, int count) const;
+
+        // Returns the number of games in the log.
+        uint64_t RecordCount() const { return recordCount; }
+
+        // Returns whether Open() rebuilt the index from the full log.
+        bool RebuiltIndex() const { return rebuilt; }
+};
+
+#endif // LEADERBOARD_H
@@ -0,0 +1,167 @@
+#include "level.h"
+
+#include <cstddef>      // offsetof for the checksum field
+#include <cstdio>       // fopen/fwrite for saving
+#include <cstdlib>      // abs for the direction check
+#include <cstring>      // memcpy/memcmp for the packed layout
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Function to append the raw bytes of a value to a buffer
+template <typename T>
+static void AppendBytes(vector<uint8_t>& buffer, const T& value) {
+    const uint8_t* bytes = (const uint8_t*)&value;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// Function to round an offset up to the next multiple of 8
+static uint64_t AlignTo8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+// Function to check the rules against a board: the whole starting snake on free cells, margins that leave a spawn area
+template <typename IsWallFn>
+static bool ValidRules(int boardSize, const LevelRules& rules, IsWallFn&& isWall) {
+    Cell direction = rules.direction;
+    if (abs(direction.x) + abs(direction.y) != 1 || rules.startLength < 1 || rules.startLength > 255) {
+        return false;
+    }
+    for (int i = 0; i < rules.startLength; i++) {
+        Cell cell = Cell{rules.start.x - direction.x * i, rules.start.y - direction.y * i};
+        if ((unsigned)cell.x >= (unsigned)boardSize || (unsigned)cell.y >= (unsigned)boardSize || isWall(cell)) {
+            return false;
+        }
+    }
+    for (int margin : rules.foodMargin) {
+        if (margin < 0 || 2 * margin >= boardSize) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t LevelChecksum(const uint8_t* bytes, size_t length) {
+    const size_t checksumOffset = offsetof(LevelHeader, checksum);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        bool inChecksum = i >= checksumOffset && i < checksumOffset + sizeof(uint32_t);
+        hash = (hash ^ (inChecksum ? 0 : bytes[i])) * 16777619u;
+    }
+    return hash;
+}
+
+bool WriteLevel(const string& path, const LevelDescription& level) {
+    const int size = level.boardSize;
+    const uint64_t area = (uint64_t)size * size;
+    if (!ValidBoardSize(size) || (!level.walls.empty() && level.walls.size() != area)) {
+        return false;
+    }
+    auto isWall = [&](Cell cell) { return !level.walls.empty() && level.walls[(size_t)cell.y * size + cell.x] != 0; };
+    if (!ValidRules(size, level.rules, isWall)) {
+        return false;
+    }
+
+    LevelHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SNLV", 4);
+    header.version = levelVersion;
+    header.boardSize = (uint32_t)size;
+    header.messageCount = (uint32_t)level.messages.size();
+    header.startX = (int16_t)level.rules.start.x;
+    header.startY = (int16_t)level.rules.start.y;
+    header.directionX = (int8_t)level.rules.direction.x;
+    header.directionY = (int8_t)level.rules.direction.y;
+    header.startLength = (uint8_t)level.rules.startLength;
+    for (int i = 0; i < 4; i++) {
+        header.foodMargin[i] = (uint8_t)level.rules.foodMargin[i];
+    }
+    header.wallsOffset = sizeof(LevelHeader);
+    header.messageIndexOffset = AlignTo8(header.wallsOffset + (area + 7) / 8);
+    header.textOffset = AlignTo8(header.messageIndexOffset + (level.messages.size() + 1) * sizeof(uint32_t));
+
+    vector<uint8_t> file;
+    AppendBytes(file, header);
+    file.resize(header.messageIndexOffset, 0);
+    for (uint64_t i = 0; i < area && !level.walls.empty(); i++) {
+        if (level.walls[i] != 0) {
+            file[header.wallsOffset + i / 8] |= (uint8_t)(1 << (i & 7));
+        }
+    }
+    uint32_t textPosition = 0;
+    for (const string& message : level.messages) {
+        AppendBytes(file, textPosition);
+        textPosition += (uint32_t)message.size() + 1;
+    }
+    AppendBytes(file, textPosition);
+    file.resize(header.textOffset, 0);
+    for (const string& message : level.messages) {
+        file.insert(file.end(), message.begin(), message.end());
+        file.push_back(0);
+    }
+    header.textSize = textPosition;
+    memcpy(file.data(), &header, sizeof(header));
+    header.checksum = LevelChecksum(file.data(), file.size());
+    memcpy(file.data(), &header, sizeof(header));
+
+    FILE* stream = fopen(path.c_str(), "wb");
+    if (stream == nullptr) {
+        return false;
+    }
+    bool written = fwrite(file.data(), 1, file.size(), stream) == file.size();
+    return fclose(stream) == 0 && written;
+}
+
+bool Level::Open(const string& path) {
+    Close();
+    if (!file.Open(path) || file.Size() < sizeof(LevelHeader)) {
+        file.Close();
+        return false;
+    }
+    const uint8_t* bytes = file.Data();
+    const size_t length = file.Size();
+    memcpy(&header, bytes, sizeof(header));
+    uint64_t area = (uint64_t)header.boardSize * header.boardSize;
+    uint64_t indexSize = ((uint64_t)header.messageCount + 1) * sizeof(uint32_t);
+    bool valid = memcmp(header.magic, "SNLV", 4) == 0 && header.version == levelVersion &&
+                 header.boardSize >= (uint32_t)minBoardSize && header.boardSize <= (uint32_t)maxBoardSize &&
+                 header.wallsOffset <= length && (area + 7) / 8 <= length - header.wallsOffset &&
+                 header.messageIndexOffset <= length && indexSize <= length - header.messageIndexOffset &&
+                 header.textOffset <= length && header.textSize <= length - header.textOffset;
+    if (valid) {
+        data = bytes;
+        rules.start = Cell{header.startX, header.startY};
+        rules.direction = Cell{header.directionX, header.directionY};
+        rules.startLength = header.startLength;
+        for (int i = 0; i < 4; i++) {
+            rules.foodMargin[i] = header.foodMargin[i];
+        }
+        valid = ValidRules(BoardSize(), rules, [this](Cell cell) { return IsWall(cell); });
+    }
+    // Messages are read in place, so every offset must stay inside the text block and end on a NUL
+    for (uint32_t i = 0; valid && i < header.messageCount; i++) {
+        uint32_t begin, end;
+        memcpy(&begin, bytes + header.messageIndexOffset + i * sizeof(uint32_t), sizeof(begin));
+        memcpy(&end, bytes + header.messageIndexOffset + (i + 1) * sizeof(uint32_t), sizeof(end));
+        valid = begin < end && end <= header.textSize && bytes[header.textOffset + end - 1] == 0;
+    }
+    if (!valid) {
+        Close();
+    }
+    return valid;
+}
+
+void Level::Close() {
+    file.Close();
+    data = nullptr;
+    rules = LevelRules();
+}
+
+const char* Level::Message(int index) const {
+    uint32_t begin;
+    memcpy(&begin, data + header.messageIndexOffset + (size_t)index * sizeof(uint32_t), sizeof(begin));
+    return (const char*)(data + header.textOffset + begin);
+}
+
+bool Level::VerifyChecksum() const {
+    return IsOpen() && LevelChecksum(data, file.Size()) == header.checksum;
+}
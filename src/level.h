@@ -0,0 +1,124 @@
+#ifndef LEVEL_H
+#define LEVEL_H
+
+#include <cstddef>      // size_t for the file length
+#include <cstdint>      // Fixed-width fields of the file format
+#include <string>       // File paths and messages
+#include <vector>       // Walls and messages of a level being written
+
+#include "mapped_file.h"
+#include "simulation.h"
+
+// Binary level, designed to be used straight from a memory mapping (see
+// MappedFile): opening checks the header and section bounds, nothing is
+// parsed or copied. All fields are little-endian and every section starts on
+// an 8-byte boundary:
+//
+//   LevelHeader
+//   wall bitmap     ceil(boardSize^2 / 8) bytes, row-major; bit (i & 7) of
+//                   byte i / 8 is set when cell i is a wall
+//   message index   (messageCount + 1) x uint32_t offsets into the text block
+//   text block      the messages (UTF-8), each followed by a NUL
+//
+// The walls feed OccupancyGrid::SetWalls() as they are, so obstacle
+// collisions are the same per-cell lookup as body collisions.
+
+const uint16_t levelVersion = 1;
+
+struct LevelHeader {
+    char magic[4]; // "SNLV" (the leaderboard log starts with "SNKL")
+    uint16_t version; // levelVersion
+    uint16_t reserved;
+    uint32_t boardSize; // Cells along each side of the board
+    uint32_t messageCount; // Entries in the message table
+    int16_t startX; // Head of the starting snake
+    int16_t startY;
+    int8_t directionX; // Starting direction
+    int8_t directionY;
+    uint8_t startLength; // Segments of the starting snake, laid out behind the head
+    uint8_t reserved2;
+    uint8_t foodMargin[4]; // Spawn margin per SpeedLevel
+    uint32_t checksum; // FNV-1a of the file with this field zeroed, identifies the level in replays
+    uint64_t wallsOffset; // File offset of the wall bitmap
+    uint64_t messageIndexOffset; // File offset of the message index
+    uint64_t textOffset; // File offset of the text block
+    uint64_t textSize; // Size of the text block in bytes
+};
+static_assert(sizeof(LevelHeader) == 64, "LevelHeader layout is part of the file format");
+
+// A level as written by WriteLevel().
+struct LevelDescription {
+    int boardSize = cellCount; // Cells along each side
+    LevelRules rules; // Start and spawn rules
+    std::vector<uint8_t> walls; // One byte per cell, row-major, non-zero for a wall (empty for none)
+    std::vector<std::string> messages; // Message table shown by the front end
+};
+
+// Function to write a level file, returns false on I/O errors or invalid rules
+bool WriteLevel(const std::string& path, const LevelDescription& level);
+
+// Read-only level mapped from a file.
+class Level {
+    private:
+        MappedFile file; // Mapping of the level file
+        const uint8_t* data = nullptr; // Start of the level bytes, null when closed
+        LevelHeader header; // Copy of the validated header
+        LevelRules rules; // Rules decoded from the header
+
+    public:
+        Level() {}
+
+        Level(const Level&) = delete;
+        Level& operator=(const Level&) = delete;
+
+        // Maps and validates a level file, returns false for a missing, damaged or foreign file.
+        bool Open(const std::string& path);
+
+        // Unmaps the file.
+        void Close();
+
+        // Returns whether a level is open.
+        bool IsOpen() const { return data != nullptr; }
+
+        // Returns the validated header.
+        const LevelHeader& Header() const { return header; }
+
+        // Returns the number of cells along each side.
+        int BoardSize() const { return (int)header.boardSize; }
+
+        // Returns the start and spawn rules.
+        const LevelRules& Rules() const { return rules; }
+
+        // Returns the wall bitmap, in the layout OccupancyGrid::SetWalls() takes.
+        const uint8_t* WallBits() const { return data + header.wallsOffset; }
+
+        // Returns whether an on-board cell is a wall.
+        bool IsWall(Cell cell) const {
+            int index = cell.y * BoardSize() + cell.x;
+            return (WallBits()[index >> 3] >> (index & 7)) & 1;
+        }
+
+        // Returns the number of messages.
+        int MessageCount() const { return (int)header.messageCount; }
+
+        // Returns a NUL-terminated message, pointing into the mapping.
+        const char* Message(int index) const;
+
+        // Recomputes the checksum over the whole file, returns whether it matches the header.
+        bool VerifyChecksum() const;
+
+        // Method to put 'sim' on this level, returns false if the board sizes differ
+        template <typename BoardT>
+        bool Apply(BasicSimulation<BoardT>& sim) const {
+            if (!IsOpen() || sim.GetBoard().CellCount() != BoardSize()) {
+                return false;
+            }
+            sim.SetLevel(rules, WallBits());
+            return true;
+        }
+};
+
+// Function to compute a level checksum: FNV-1a of the bytes with the header's checksum field read as zero
+uint32_t LevelChecksum(const uint8_t* bytes, size_t length);
+
+#endif // LEVEL_H
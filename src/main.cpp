@@ -1,10 +1,19 @@
 #include <iostream>     // Includes the Standard I/O library for input and output operations
 #include <raylib.h>     // Includes the Raylib library, a simple and easy-to-use library to enjoy videogames programming
-#include <deque>        // Includes the deque (double-ended queue) container from the C++ standard library
-#include <raymath.h>    // Includes Raylib's math functions for vector operations
 #include <vector>       // Includes the vector container from the C++ standard library
 #include <string>       // Includes the string class from the C++ standard library
 #include <algorithm>    // Includes the C++ standard library's algorithm library for various functions
+#include <ctime>        // Includes time() used to seed the simulation
+#include <memory>       // Includes shared_ptr used to hold the asset registry
+#include "simulation.h" // Includes the headless game simulation (snake, food, collisions)
+#include "assets.h"     // Includes the shared texture and sound registry
+#include "mapped_file.h" // Includes EnsureDirectory used for the replay folder
+#include "sim_thread.h" // Includes the fixed-step simulation thread and its input queue
+#include "leaderboard.h" // Includes the persistent leaderboard
+#include "text_cache.h" // Includes text rendered once into textures
+#include "profiler.h"   // Includes the scoped timers behind the F1 overlay
+#include "playfield_cache.h" // Includes the board painted into a texture and repainted per changed cell
+#include "level.h"      // Includes the memory-mapped level files
 
 #define MAX_INPUT_CHARS 12 // Define a constant for the maximum number of characters in input
 
@@ -16,57 +25,10 @@ Color snakeColor = {43, 51, 24, 255};                // Snake color
 
 // Define game parameters
 int cellSize = 30;      // The size of each cell in pixels
-int cellCount = 29;     // The number of cells in the grid
 int offset = 75;        // The border offset for the game window
-double lastUpdateTime = 0;   // The time of the last update for event handling
-
-// Enumeration for different speed levels in the game
-enum class SpeedLevel {
-    SLOW,
-    MEDIUM,
-    FAST,
-    VERY_FAST
-};
-
-// Structure to hold player data
-struct PlayerData {
-    string name; // Stores the player's name
-    int score; // Stores the player's score
-    SpeedLevel difficulty; // Stores the difficulty level chosen by the player
-};
-
-// Function to convert SpeedLevel enum to a string for display
-string SpeedLevelToString(SpeedLevel level) {
-    switch(level) {
-        case SpeedLevel::SLOW: return "Slow";
-        case SpeedLevel::MEDIUM: return "Medium";
-        case SpeedLevel::FAST: return "Fast";
-        case SpeedLevel::VERY_FAST: return "Very Fast";
-        default: return "Unknown";
-    }
-}
-
-// Function to check if an element is in a deque of Vector2s
-bool ElementInDeque(Vector2 element, deque<Vector2> deque){
-    for(unsigned int i = 0; i < deque.size(); i++) {
-        if(Vector2Equals(deque[i], element)) {
-            return true; // Returns true if the element is found
-        }
-    }
-    return false; // Returns false if the element is not found
-}
-
-// Function to check if a certain time interval has passed
-bool eventTriggered(double interval){
-    double currentTime = GetTime(); // Gets the current time
-    if (currentTime - lastUpdateTime >= interval) {
-        lastUpdateTime = currentTime; // Updates the last update time
-        return true; // Returns true if the interval has passed
-    }
-    return false; // Returns false otherwise
-}
+int playfieldBorder = 5; // Thickness of the line around the board
 
-// Remaining code for classes GameMenu, Snake, Food, and Game...
+// Remaining code for classes GameMenu and Game...
 
 
 
@@ -80,7 +42,9 @@ class GameMenu {
         int speedLevelIndex = 0; // Stores the index of the currently selected speed level.
         Rectangle nameInputBox; // Represents the graphical area where the player inputs their name.
         string playerName; // Stores the player's name.
-        vector<PlayerData> players; // Stores data for all players in the current session.
+        CachedText labels; // The static menu labels, rendered once
+        CachedText nameText; // The entered name, re-rendered when it changes
+        CachedText speedText; // The selected speed level, re-rendered when it changes
 
     public:
         // Constructor initializes the menu with the first color options and sets the menu as active.
@@ -104,20 +68,34 @@ class GameMenu {
         // Renders the menu screen.
         void DisplayMenu() {
             ClearBackground(RAYWHITE); // Clears the screen and sets a white background.
-            DrawText("Game Menu", 400, 50, 20, BLACK); // Displays the menu title.
-            DrawText("Use arrow keys to change colors", 350, 100, 20, DARKGRAY); // Shows instructions for color selection.
-            DrawText("Background Color", 400, 150, 20, BLACK); // Label for background color selection.
+            // The labels never change, so they are laid out once (coordinates relative to (350, 50))
+            labels.Render("labels", 400, 470, [] {
+                DrawText("Game Menu", 50, 0, 20, BLACK); // Displays the menu title.
+                DrawText("Use arrow keys to change colors", 0, 50, 20, DARKGRAY); // Shows instructions for color selection.
+                DrawText("Background Color", 50, 100, 20, BLACK); // Label for background color selection.
+                DrawText("Snake Color", 50, 150, 20, BLACK); // Label for snake color selection.
+                DrawText("Speed Level < >", 50, 200, 20, BLACK); // Label for speed level selection.
+                DrawText("Enter your name: ", 50, 250, 20, BLACK); // Prompts for name input.
+                DrawText("Press ENTER to start", 50, 450, 20, DARKBLUE); // Indicates how to start the game.
+            });
+            labels.Draw(350, 50, WHITE);
             DrawRectangle(600, 145, 20, 20, colorOptions[backgroundColorIndex]); // Shows the selected background color.
-            DrawText("Snake Color", 400, 200, 20, BLACK); // Label for snake color selection.
             DrawRectangle(600, 195, 20, 20, colorOptions[snakeColorIndex]); // Shows the selected snake color.
-            DrawText("Enter your name: ", 400, 300, 20, BLACK); // Prompts for name input.
             DrawRectangleRec(nameInputBox, LIGHTGRAY); // Renders the name input box.
             DrawRectangleLines((int)nameInputBox.x, (int)nameInputBox.y, (int)nameInputBox.width, (int)nameInputBox.height, DARKGRAY); // Draws the outline for the input box.
-            DrawText(playerName.c_str(), (int)nameInputBox.x + 5, (int)nameInputBox.y + 8, 40, MAROON); // Displays the entered name.
-            DrawText("Press ENTER to start", 400, 500, 20, DARKBLUE); // Indicates how to start the game.
-            DrawText("Speed Level < >", 400, 250, 20, BLACK); // Label for speed level selection.
+            nameText.SetText(playerName, 40);
+            nameText.Draw((int)nameInputBox.x + 5, (int)nameInputBox.y + 8, MAROON); // Displays the entered name.
             const char* speedLevels[] = {"Slow", "Medium", "Fast", "Very Fast"}; // Speed level options.
-            DrawText(speedLevels[speedLevelIndex], 600, 245, 20, BLACK); // Displays the selected speed level.
+            speedText.SetText(speedLevels[speedLevelIndex], 20);
+            speedText.Draw(600, 245, BLACK); // Displays the selected speed level.
+        }
+
+        // Renders a progress bar under the menu while assets are still loading.
+        void DisplayLoading(float progress) {
+            int percent = (int)(progress * 100.0f);
+            DrawRectangle(400, 560, 325, 10, LIGHTGRAY); // Bar background
+            DrawRectangle(400, 560, (int)(325 * progress), 10, DARKBLUE); // Loaded fraction
+            DrawText(TextFormat("Loading assets %d%%", percent), 400, 575, 20, DARKGRAY);
         }
 
         // Handles user input for the menu.
@@ -189,145 +167,94 @@ class GameMenu {
     };
 
 
-class Snake {
-    public:
-        // A deque to represent the snake's body, each segment as a Vector2 (x, y position).
-        deque<Vector2> body = {Vector2{6,9}, Vector2{5,9}, Vector2{4,9}};
-        // The direction the snake is moving in, initially set to move right (1, 0).
-        Vector2 direction = {1, 0};
-        // A flag to indicate whether a new segment should be added to the snake's body.
-        bool addSegment = false;
-        // Method to draw the snake on the screen.
-        void Draw() {
-            // Iterates through each segment in the snake's body.
-            for(long unsigned int i = 0; i < body.size(); i++) {
-                // Creates a rectangle to visually represent each segment.
-                Rectangle segment = Rectangle{
-                    offset + body[i].x * cellSize, // X position
-                    offset + body[i].y * cellSize, // Y position
-                    (float)cellSize,              // Width
-                    (float)cellSize               // Height
-                };
-                // Draws the segment as a rounded rectangle using the snake's color.
-                DrawRectangleRounded(segment, 0.5, 6, snakeColor);
-            }
-        }
-        // Method to update the snake's state, including its position and size.
-        void Update() {
-            // Adds a new segment to the front of the snake in its current direction.
-            body.push_front(Vector2Add(body[0], direction));
-            // Checks if a new segment should be added.
-            if(addSegment) {
-                addSegment = false; // Resets the flag if a segment was added.
-            } else {
-                body.pop_back(); // Removes the last segment of the body if not growing.
-            }
-        }
-        // Method to reset the snake to its initial state.
-        void Reset() {
-            // Reinitializes the snake's body to its starting size and position.
-            body = {Vector2{6,9}, Vector2{5,9}, Vector2{4,9}};
-            // Resets the direction of the snake to move right.
-            direction = {1, 0};
-        }
-    };
-
+// Function to map a direction key (arrows or WASD) to a simulation input
+Input KeyToInput(int key) {
+    switch (key) {
+        case KEY_UP: case KEY_W: return Input::UP;
+        case KEY_DOWN: case KEY_S: return Input::DOWN;
+        case KEY_LEFT: case KEY_A: return Input::LEFT;
+        case KEY_RIGHT: case KEY_D: return Input::RIGHT;
+        default: return Input::NONE;
+    }
+}
 
-class Food {
+class ProfilerOverlay {
     private:
-        SpeedLevel currentDifficulty;
+        bool visible = false; // Whether the overlay is drawn (profiling runs only while it is)
+        double frameMs = 0; // Smoothed time between frames, in milliseconds
+
     public:
-        Vector2 position;    // Stores the position of the food
-        std::vector<Texture2D> textures; // Updated to store multiple textures
-        int textureIndex; // Index to keep track of the current texture
-        std::vector<Sound> eatSounds; // Updated to store multiple sounds
-        int soundIndex; // Index to keep track of the current sound
-        Food(deque<Vector2> snakeBody, SpeedLevel difficulty) : currentDifficulty(difficulty) {
-            // Load multiple textures
-            //textures.push_back(LoadTexture("Graphics/Beluga_food1.png"));
-            textures.push_back(LoadTexture("Graphics/aa.png"));
-            textures.push_back(LoadTexture("Graphics/ab.png"));
-            textures.push_back(LoadTexture("Graphics/ac.png"));
-            for (char letterr = 'a'; letterr <= 'z'; ++letterr) {
-                std::string filename = "Graphics/" + std::string(1, letterr) + ".png";
-                textures.push_back(LoadTexture(filename.c_str()));  // Convert to C-style string
-            }
-
-            // Initialize texture index
-            textureIndex = GetRandomValue(0, textures.size() - 1);
-            // Load multiple sounds
-            eatSounds.push_back(LoadSound("Sounds/aa.mp3"));
-            eatSounds.push_back(LoadSound("Sounds/ab.mp3"));
-            eatSounds.push_back(LoadSound("Sounds/ac.mp3"));
-            //eatSounds.push_back(LoadSound("Sounds/c.mp3"));
-            for (char letter = 'a'; letter <= 'z'; ++letter) {
-                std::string filename = "Sounds/" + std::string(1, letter) + ".mp3";
-                eatSounds.push_back(LoadSound(filename.c_str()));  // Convert to C-style string
-            }
-
-            // Initialize sound index
-            soundIndex = GetRandomValue(0, eatSounds.size() - 1);
-            for (const auto& sound : eatSounds) {
-                if (sound.stream.buffer == nullptr) {
-                    // Display a message indicating that the sound failed to load
-                    printf("Error loading sound file.\n");
+        // F1 toggles the overlay and the profiler, F3 starts or stops a Chrome trace recording.
+        void HandleInput() {
+            if (IsKeyPressed(KEY_F1)) {
+                visible = !visible;
+                Profiler::SetEnabled(visible);
+            }
+            if (IsKeyPressed(KEY_F3) && visible) {
+                Profiler& profiler = Profiler::Get();
+                if (!profiler.IsTracing()) {
+                    profiler.StartTrace();
+                } else {
+                    string path = TextFormat("profile-%lld.json", (long long)time(nullptr));
+                    if (profiler.StopTrace(path)) {
+                        cout << "Wrote trace " << path << " (open it in chrome://tracing or ui.perfetto.dev)" << endl;
+                    }
                 }
             }
-            position = GenerateRandomPos(snakeBody);
         }
-        ~Food() {
-            // Unload all textures
-            for (const auto& texture : textures) {
-                UnloadTexture(texture);
-            }
-            // Unload all sounds
-            for (const auto& sound : eatSounds) {
-                UnloadSound(sound);
+
+        // Gathers the samples every thread recorded since the last frame.
+        void Collect() {
+            if (visible) {
+                Profiler::Get().Collect();
+                frameMs = frameMs * 0.95 + GetFrameTime() * 1000.0 * 0.05;
             }
         }
-        void Draw() {
-            // Draw the current texture at the specified position
-            DrawTexture(textures[textureIndex], offset + position.x * cellSize, offset + position.y * cellSize, Fade(WHITE, 0.5f)); // 
-        }
-        Vector2 GenerateRandomCell() { //UPDT difficulty level
-        int minDistance;
-        switch (currentDifficulty) {
-            case SpeedLevel::SLOW:       minDistance = 4; break;
-            case SpeedLevel::MEDIUM:     minDistance = 3; break;
-            case SpeedLevel::FAST:       minDistance = 2; break;
-            case SpeedLevel::VERY_FAST:  minDistance = 1; break;
-            default:                     minDistance = 1;
-        }
-        float x = GetRandomValue(minDistance, cellCount - 1 - minDistance);
-        float y = GetRandomValue(minDistance, cellCount - 1 - minDistance);
-        return Vector2{x, y};
-        }
-        Vector2 GenerateRandomPos(deque<Vector2> snakeBody) {
-            Vector2 position = GenerateRandomCell();
-            // Ensures the generated position is not already occupied by the snake's body
-            while(ElementInDeque(position, snakeBody)) {
-                position = GenerateRandomCell(); // Generates a new random cell position
+
+        // Draws p50/p99 of every profiled scope in the bottom-left corner.
+        void Draw(bool batchedSnake, bool cachedPlayfield, int repaintedCells, double tickLateMs, Color color) const {
+            if (!visible) {
+                return;
+            }
+            const Profiler& profiler = Profiler::Get();
+            int y = 2 * offset + cellSize * cellCount - 25;
+            DrawText(TextFormat("frame %.2f ms | tick late %.2f ms | snake %s (F2) | %s", frameMs, tickLateMs,
+                                batchedSnake ? "batched" : "per segment", profiler.IsTracing() ? "TRACING (F3 to stop)" : "F3 to trace"),
+                     10, y, 20, color);
+            y -= 22;
+            if (!cachedPlayfield) {
+                DrawText("playfield live, interpolated (F5)", 10, y, 20, color);
+            } else if (repaintedCells < 0) {
+                DrawText("playfield cached, repainted whole (F5)", 10, y, 20, color);
+            } else {
+                DrawText(TextFormat("playfield cached, %d cells repainted (F5)", repaintedCells), 10, y, 20, color);
+            }
+            for (auto it = profiler.AllStats().rbegin(); it != profiler.AllStats().rend(); ++it) {
+                y -= 22;
+                DrawText(TextFormat("%-16s p50 %7.3f ms  p99 %7.3f ms", it->first.c_str(), it->second.PercentileMs(0.50), it->second.PercentileMs(0.99)),
+                         10, y, 20, color);
             }
-            return position; // Returns the final unoccupied position
         }
-    };
+};
 
 class Game {
     // Private member variables
     GameMenu* menu; // Pointer to the game menu, for accessing and modifying menu state.
-    bool difficultyHasChanged; // Flag to track if the game's difficulty level has changed.
-    SpeedLevel newDifficulty; // Stores the new difficulty level when a change is requested.
 
     // Public member variables and methods
     public:
-        Snake snake; // An instance of the Snake class, representing the player-controlled snake.
-        Food food;   // An instance of the Food class, representing the food in the game.
-        bool running = true; // Flag indicating whether the game is currently running.
-        int score = 0; // Variable to keep track of the player's score.
-        Sound wallSound; // Sound effect for when the snake hits a wall.
+        SpeedCurveSet speedCurves; // Tick period tables of the speed levels, declared first so they outlive simThread
+        SimulationThread simThread; // Plays the headless simulation at a fixed step on its own thread and records each run.
+        uint64_t runSeed = 0; // Seed the current run was started with
+        shared_ptr<AssetRegistry> assets; // Textures and sounds, loaded once and shared
+        int textureIndex; // Index of the current food sprite in the registry's atlas
+        int soundIndex; // Index of the next eating sound in the registry
         string playerName; // Variable to store the current player's name.
-        vector<PlayerData> players; // Vector to store data for all players (e.g., for a leaderboard).
-        SpeedLevel speedLevel = SpeedLevel::SLOW; // The current speed level of the game.
+        Leaderboard leaderboard; // Every finished game on disk, with the best ones of each speed level indexed
+        CachedText messageText; // Current entry of 'messages', re-rendered when the index changes
+        CachedText scoreText; // Current score, re-rendered when it changes
+        CachedText leaderboardText; // Best games of 'leaderboardLevel', re-rendered when a game ends or the menu level changes
+        SpeedLevel leaderboardLevel = SpeedLevel::SLOW; // Speed level 'leaderboardText' lists
         vector<std::string> messages = {
     "0. Arhitectura sistemelor de calcul",
     "1. Fundamentele programării",
@@ -360,154 +287,200 @@ class Game {
     "28. Securitatea sistemelor informatice"
 }; // Messages to display at various points in the game.
         int currentMessageIndex = 0; // Index to keep track of which message is currently displayed.
+        RenderTexture2D segmentTexture; // One rounded segment, reused for every cell of the snake
+        bool batchedSnake = true; // Draw the snake from segmentTexture (true) or tessellate each segment (false)
+        PlayfieldCache playfield; // Board, border, snake and food painted once and repainted per changed cell
+        bool cachedPlayfield = false; // Present 'playfield' (true, snake moves cell by cell) or redraw and interpolate the snake every frame (false)
+        Level level; // Level file played on, if one was given
+        vector<Cell> walls; // Wall cells of that level
 
-        // Method to calculate the update interval based on speed level and score
-        double GetUpdateInterval() {
-            double baseInterval = 0.22; // Default interval
-            // Adjust interval based on speed level
-            switch(speedLevel) {
-                case SpeedLevel::SLOW: baseInterval = 0.22; break;
-                case SpeedLevel::MEDIUM: baseInterval = 0.17; break;
-                case SpeedLevel::FAST: baseInterval = 0.14; break;
-                case SpeedLevel::VERY_FAST: baseInterval = 0.07; break;
-            }
-            // Adjust interval based on score
-            double interval = baseInterval - (score / 3000.0);
-            return (interval > 0.05) ? interval : 0.05; // Ensure interval doesn't get too low.
-        }
+        // Constructor for the Game class
+        Game() : menu(nullptr), simThread((uint64_t)time(nullptr)), assets(AssetRegistry::Acquire()),
+                 playfield(cellSize, cellCount, playfieldBorder) {
+            textureIndex = GetRandomValue(0, assets->FoodVariantCount() - 1); // Initialize texture index
+            soundIndex = GetRandomValue(0, assets->eatSounds.size() - 1); // Initialize sound index
 
-        // Method to set the game menu
-        void SetMenu(GameMenu* menu) {
-            this->menu = menu;
-        }
+            // Tessellate the rounded segment once in white; drawing tints it with the snake color
+            segmentTexture = LoadRenderTexture(cellSize, cellSize);
+            BeginTextureMode(segmentTexture);
+            ClearBackground(BLANK);
+            DrawRectangleRounded(Rectangle{0, 0, (float)cellSize, (float)cellSize}, 0.5, 6, WHITE);
+            EndTextureMode();
+
+            // The speed curves are optional; without the file every level keeps its classic curve
+            string error;
+            if (FileExists("speed_curves.txt") && !speedCurves.Load("speed_curves.txt", error)) {
+                cerr << "Could not load speed curves: " << error << endl;
+            }
+            simThread.UseSpeedCurves(speedCurves);
 
-        // Method to request a change in game difficulty
-        void ChangeDifficulty(SpeedLevel newLevel) {
-            newDifficulty = newLevel;
-            difficultyHasChanged = true;
+            if (!leaderboard.Open("leaderboard.log", "leaderboard.idx")) {
+                cerr << "Could not open the leaderboard, scores will not be saved" << endl;
+            }
         }
 
-        // Method to update the game's difficulty
-        void SetDifficulty(SpeedLevel newLevel) {
-            speedLevel = newLevel;
-            food = Food(snake.body, speedLevel); // Update food according to new difficulty.
+        // Destructor for the Game class
+        ~Game() {
+            UnloadRenderTexture(segmentTexture);
         }
 
-        // Constructor for the Game class
-        Game() : snake(), food(snake.body, speedLevel), difficultyHasChanged(false), newDifficulty(SpeedLevel::SLOW) {
-            wallSound = LoadSound("Sounds/Crash_wall.mp3"); // Load the sound for hitting a wall.
+        // Method to play the following runs on a level file; its messages replace the built-in ones
+        bool LoadLevel(const string& path) {
+            if (!level.Open(path)) {
+                cerr << "Could not open level " << path << endl;
+                return false;
+            }
+            if (!simThread.UseLevel(level)) {
+                cerr << "Level " << path << " is " << level.BoardSize() << "x" << level.BoardSize() << ", the window shows a " << cellCount << "x" << cellCount << " board" << endl;
+                level.Close();
+                return false;
+            }
+            if (level.MessageCount() > 0) {
+                messages.clear();
+                for (int i = 0; i < level.MessageCount(); i++) {
+                    messages.push_back(level.Message(i));
+                }
+                currentMessageIndex = 0;
+            }
+            walls.clear();
+            for (int y = 0; y < cellCount; y++) {
+                for (int x = 0; x < cellCount; x++) {
+                    if (level.IsWall(Cell{x, y})) {
+                        walls.push_back(Cell{x, y});
+                    }
+                }
+            }
+            playfield.SetWalls(walls);
+            return true;
         }
 
-        // Destructor for the Game class
-        ~Game() {
-            UnloadSound(wallSound); // Unload the wall collision sound.
+        // Method to set the game menu
+        void SetMenu(GameMenu* menu) {
+            this->menu = menu;
         }
 
-        // Method to draw game elements
-        void Draw() {
-            food.Draw();  // Draw the food.
-            snake.Draw(); // Draw the snake.
+        // Method to return where a segment is drawn, 'alpha' of the way from its previous cell to its current one
+        static Vector2 SegmentPosition(const FrameSnapshot& frame, size_t i, float alpha) {
+            Cell to = frame.body[i];
+            Cell from = (frame.continuous && i < frame.previousBody.size()) ? frame.previousBody[i] : to;
+            return Vector2{offset + (from.x + (to.x - from.x) * alpha) * cellSize, offset + (from.y + (to.y - from.y) * alpha) * cellSize};
         }
 
-        // Method to update the game state
-        void Update() {
-            if (running) {
-                snake.Update(); // Update the snake's position and size.
-                CheckCollisionWithFood(); // Check for collisions with food.
-                CheckCollisionWithEdges(); // Check for collisions with the edges of the game area.
-                CheckCollisionWithTail();  // Check for collisions with the snake's own tail.
-
-                // If the difficulty has changed, update it and reset the flag.
-                if (difficultyHasChanged) {
-                    SetDifficulty(newDifficulty);
-                    difficultyHasChanged = false;
-                }
+        // Method to draw the food sprite (or, while the atlas loads, a marker) with its cell's top-left corner at 'position'
+        void DrawFoodAt(Vector2 position) const {
+            if (assets->foodSprites.empty()) {
+                // The atlas is still loading, so stand in a plain marker for the sprite
+                DrawRectangleRounded(Rectangle{position.x + 5, position.y + 5, (float)cellSize - 10, (float)cellSize - 10}, 0.5f, 6, Fade(snakeColor, 0.5f));
+            } else {
+                DrawTextureRec(assets->foodAtlas, assets->foodSprites[textureIndex], position, Fade(WHITE, 0.5f));
             }
         }
 
-        // Method to check for collisions with food
-        void CheckCollisionWithFood() {
-            if(Vector2Equals(snake.body[0], food.position)) {
-                // If the snake's head is at the same position as the food
-                food.position = food.GenerateRandomPos(snake.body); // Move the food to a new position.
-                food.textureIndex = (food.textureIndex + 1) % food.textures.size(); // Change the food's texture.
-                snake.addSegment = true; // Grow the snake.
-                score += 10; // Increase the score.
-                currentMessageIndex = (currentMessageIndex + 1) % messages.size(); // Update the message index.
-                PlaySound(food.eatSounds[food.soundIndex]); // Play the eating sound.
-                food.soundIndex = (food.soundIndex + 1) % food.eatSounds.size(); // Change the eating sound.
+        // Method to draw one snake segment with its top-left corner at 'position'
+        void DrawSegmentAt(Vector2 position) const {
+            if (batchedSnake) {
+                // Every segment is a quad of the same texture, so raylib's batcher
+                // merges the whole snake into a single draw call.
+                // Render textures are stored upside down, hence the negative source height.
+                DrawTextureRec(segmentTexture.texture, Rectangle{0, 0, (float)cellSize, -(float)cellSize}, position, snakeColor);
+            } else {
+                // Draw the segment as a rounded rectangle using the snake's color.
+                DrawRectangleRounded(Rectangle{position.x, position.y, (float)cellSize, (float)cellSize}, 0.5, 6, snakeColor);
             }
         }
 
-        // Method to check for collisions with the game area edges
-        void CheckCollisionWithEdges() {
-            // Check if the snake's head is beyond the game area boundaries
-            if(snake.body[0].x < 0 || snake.body[0].x >= cellCount || snake.body[0].y < 0 || snake.body[0].y >= cellCount) {
-                GameOver(); // End the game if there is a collision.
+        // Method to draw game elements: from the cached playfield, repainting only the cells the
+        // last tick changed, or live and interpolated 'alpha' of the way between the last two ticks
+        void Draw(const FrameSnapshot& frame, float alpha) {
+            PROFILE_SCOPE("game.Draw");
+            if (cachedPlayfield) {
+                PlayfieldStyle style = {backgroundColor, snakeColor};
+                int sprite = assets->foodSprites.empty() ? -1 : textureIndex;
+                playfield.Update(frame, style, sprite, [this](Vector2 position) { DrawFoodAt(position); },
+                                 [this](Vector2 position) { DrawSegmentAt(position); });
+                playfield.Draw(offset - playfieldBorder, offset - playfieldBorder);
+                return;
+            }
+            DrawRectangleLinesEx(Rectangle{(float)offset - playfieldBorder, (float)offset - playfieldBorder, (float)cellSize * cellCount + 2 * playfieldBorder,
+                                           (float)cellSize * cellCount + 2 * playfieldBorder}, playfieldBorder, snakeColor);
+            for (const Cell& wall : walls) {
+                DrawRectangle(offset + wall.x * cellSize, offset + wall.y * cellSize, cellSize, cellSize, snakeColor);
+            }
+            // Draw the current food texture at the food's cell, unless the board had no room for it
+            if (frame.foodPlaced) {
+                DrawFoodAt(Vector2{(float)(offset + frame.food.x * cellSize), (float)(offset + frame.food.y * cellSize)});
+            }
+            for (size_t i = 0; i < frame.body.size(); i++) {
+                DrawSegmentAt(SegmentPosition(frame, i, alpha));
             }
         }
 
-           // QuickSort utility functions
-        static int Partition(vector<PlayerData>& players, int low, int high) {
-            PlayerData pivot = players[high]; // Pivot element
-            int i = (low - 1); // Index of smaller element
+        // Method to start a new run at the chosen difficulty and begin recording it
+        void StartRun(SpeedLevel level) {
+            runSeed = (uint64_t)time(nullptr);
+            simThread.Start(runSeed, level);
+        }
 
-            for (int j = low; j <= high - 1; j++) {
-                // If current element is smaller than or equal to pivot
-                if (players[j].score >= pivot.score) { // Notice we use >= to sort in descending order
-                    i++; // Increment index of smaller element
-                    swap(players[i], players[j]);
-                }
+        // Method to react to what happened in the ticks played since the last frame
+        void Update() {
+            PROFILE_SCOPE("game.Update");
+            unsigned events = simThread.TakeEvents();
+            if (events & EVENT_ATE_FOOD) {
+                textureIndex = (textureIndex + 1) % assets->FoodVariantCount(); // Change the food's texture.
+                currentMessageIndex = (currentMessageIndex + 1) % messages.size(); // Update the message index.
+                assets->audio->Play(assets->eatSounds[soundIndex]); // Play the eating sound, mixed over any still playing.
+                soundIndex = (soundIndex + 1) % assets->eatSounds.size(); // Change the eating sound.
+            }
+            if (events & EVENT_GAME_OVER) {
+                GameOver();
             }
-            swap(players[i + 1], players[high]);
-            return (i + 1);
         }
 
-        static void QuickSort(vector<PlayerData>& players, int low, int high) {
-            if (low < high) {
-                // pi is partitioning index, arr[p] is now at right place
-                int pi = Partition(players, low, high);
+        // Method to lay out the best games of a level as one cached block of text
+        void UpdateLeaderboardText(SpeedLevel level) {
+            leaderboardLevel = level;
+            string rows;
+            for (const LeaderboardEntry& entry : leaderboard.Top(level, 10)) {
+                string difficulty = SpeedLevelToString(entry.level);
+                rows += rows.empty() ? "" : "\n";
+                rows += TextFormat("Player: %s - Score: %i - Difficulty: %s", entry.name.c_str(), entry.score, difficulty.c_str());
+            }
+            leaderboardText.SetText(rows, 20, 30);
+        }
 
-                // Separately sort elements before partition and after partition
-                QuickSort(players, low, pi - 1);
-                QuickSort(players, pi + 1, high);
+        // Method to draw the message, the score and (between games) the leaderboard; text is only re-laid-out when it changed
+        void DrawHud(const FrameSnapshot& frame) {
+            PROFILE_SCOPE("game.DrawHud");
+            messageText.SetText(messages[currentMessageIndex], 40);
+            messageText.Draw(offset-52, 20, snakeColor);
+            scoreText.SetText(to_string(frame.score), 40);
+            scoreText.Draw(offset+360, offset+cellSize*cellCount+10, snakeColor);
+            if (!frame.running) {
+                leaderboardText.Draw(offset + 50, offset + 50, snakeColor);
             }
         }
 
-        // Method to sort the leaderboard using QuickSort
-        void SortLeaderboard() {
-            QuickSort(players, 0, players.size() - 1);
+        // Method to write the finished run to the replays folder
+        void SaveReplay() {
+            string path = TextFormat("replays/%lld-%llu.snkr", (long long)time(nullptr), (unsigned long long)runSeed);
+            if (!EnsureDirectory("replays") || !simThread.SaveReplay(path)) {
+                cerr << "Could not save replay " << path << endl;
+            }
         }
 
-        // Method to handle game over scenarios
+        // Method to handle game over scenarios (the simulation has already reset the board)
         void GameOver() {
-            PlayerData playerData;
-            playerData.name = playerName;
-            playerData.score = score;
-            playerData.difficulty = speedLevel; // Record the difficulty level at game over.
-            players.push_back(playerData); // Add the player's data to the leaderboard.
-            snake.Reset(); // Reset the snake to its initial state.
-            food.position = food.GenerateRandomPos(snake.body); // Move the food to a new position.
-            running = false; // Stop the game.
-            SortLeaderboard(); // Update the leaderboard.
-            score = 0; // Reset the score.
-            PlaySound(wallSound); // Play the wall collision sound.
+            const FrameSnapshot& frame = simThread.LatestFrame(); // The simulation thread has paused on this frame
+            leaderboard.Add(playerName, frame.lastScore, frame.speedLevel, (int64_t)time(nullptr)); // Record the game on disk.
+            UpdateLeaderboardText(frame.speedLevel);
+            SaveReplay();
+            assets->audio->Play(assets->wallSound); // Play the wall collision sound.
             menu->Activate(); // Reactivate the game menu.
         }
-
-        // Method to check for collisions with the snake's own body
-        void CheckCollisionWithTail() {
-            // Iterate over the snake's body segments
-            for(size_t i = 1; i < snake.body.size(); ++i) {
-                if(Vector2Equals(snake.body[0], snake.body[i])) {
-                    GameOver(); // End the game if the snake collides with its tail.
-                    break;
-                }
-            }
-        }
     };
 
-int main() {
+// Usage: game [LEVEL_FILE]
+int main(int argc, char** argv) {
     // Initialize the game window with a specific size and title
     InitWindow(2 * offset + cellSize * cellCount, 2 * offset + cellSize * cellCount, "Retro Snake");
 
@@ -517,72 +490,103 @@ int main() {
     // Initialize the audio system for playing sounds
     InitAudioDevice();
 
-    // Create instances of the GameMenu and Game classes
-    GameMenu menu;
-    Game game;
+    // The scope releases the game's textures and sounds before the devices close
+    {
+        // Create instances of the GameMenu and Game classes
+        GameMenu menu;
+        Game game;
+        ProfilerOverlay overlay;
+        bool assetsReady = false; // Set once the last asset has finished loading
+
+        // Pass the address of 'menu' to 'game' so it can interact with the menu
+        game.SetMenu(&menu);
+        game.UpdateLeaderboardText(menu.GetSpeedLevel()); // Show the stored scores before the first game of the session ends
+        if (argc > 1) {
+            game.LoadLevel(argv[1]); // Falls back to the built-in board if the file is unusable
+        }
+        Profiler::Get().SetThreadName("render");
+
+        // Main game loop - continues until the window close event is triggered
+        while (!WindowShouldClose()) {
+            // Start drawing graphics
+            BeginDrawing();
+            overlay.Collect();
+
+            // Upload whatever the loading workers finished since the last frame
+            if (!assetsReady && game.assets->Update()) {
+                assetsReady = true;
+                game.assets->PrintLoadReport(); // Report how long startup spent loading assets
+            }
+
+            // Display and handle the game menu
+            if (menu.IsActive()) {
+                {
+                    PROFILE_SCOPE("menu.Display");
+                    menu.DisplayMenu(); // Display the game menu
+                    if (!assetsReady) {
+                        menu.DisplayLoading(game.assets->Progress());
+                    }
+                }
+                {
+                    PROFILE_SCOPE("menu.HandleInput");
+                    menu.HandleInput(); // Handle player input in the menu
+                }
+                if (menu.GetSpeedLevel() != game.leaderboardLevel) {
+                    game.UpdateLeaderboardText(menu.GetSpeedLevel()); // List the best games of the newly selected level
+                }
 
-    // Pass the address of 'menu' to 'game' so it can interact with the menu
-    game.SetMenu(&menu);
+                // Configure the game based on the menu's settings
+                if (!menu.IsActive()) {
+                    backgroundColor = menu.GetBackgroundColor(); // Set background color
+                    snakeColor = menu.GetSnakeColor(); // Set snake color
+                    game.playerName = menu.GetPlayerName(); // Set player's name
+                    game.StartRun(menu.GetSpeedLevel()); // Start a fresh, recorded run at the chosen speed level
+                }
+            } else {
+                overlay.HandleInput();
+                if (IsKeyPressed(KEY_F2)) {
+                    game.batchedSnake = !game.batchedSnake; // Switch snake draw paths for comparison
+                    game.playfield.Invalidate(); // Repaint the cached snake in the new style
+                }
+                if (IsKeyPressed(KEY_F5)) {
+                    game.cachedPlayfield = !game.cachedPlayfield; // Switch between the cached and the interpolated playfield
+                    game.playfield.Invalidate();
+                }
+                if (IsKeyPressed(KEY_F4)) {
+                    game.simThread.SetAutopilot(!game.simThread.IsAutopilot()); // Let the solver play in place of the keys
+                }
 
-    // Main game loop - continues until the window close event is triggered
-    while (!WindowShouldClose()) {
-        // Start drawing graphics
-        BeginDrawing();
+                // Queue every direction key pressed this frame, in order; the simulation applies one per tick
+                for (int key = GetKeyPressed(); key != 0; key = GetKeyPressed()) {
+                    Input input = KeyToInput(key);
+                    if (input != Input::NONE) {
+                        game.simThread.PushInput(input);
+                    }
+                }
+                game.Update();
 
-        // Display and handle the game menu
-        if (menu.IsActive()) {
-            menu.DisplayMenu(); // Display the game menu
-            menu.HandleInput(); // Handle player input in the menu
+                // Interpolate between the last two ticks, so motion is smooth whatever the frame rate (live playfield only)
+                const FrameSnapshot& frame = game.simThread.LatestFrame();
+                float alpha = 1.0f;
+                if (frame.running && !game.cachedPlayfield) {
+                    alpha = (float)((SimulationThread::Now() - frame.tickTime) / frame.interval);
+                    alpha = alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+                }
 
-            // Configure the game based on the menu's settings
-            if (!menu.IsActive()) {
-                backgroundColor = menu.GetBackgroundColor(); // Set background color
-                snakeColor = menu.GetSnakeColor(); // Set snake color
-                game.playerName = menu.GetPlayerName(); // Set player's name
-                game.speedLevel = menu.GetSpeedLevel(); // Set game speed level
-            }
-        } else {
-            // Handle snake direction input
-            if ((IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) && game.snake.direction.y != 1) {
-                game.snake.direction = {0, -1}; // Move up
-                game.running = true;
-            }
-            if ((IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_S)) && game.snake.direction.y != -1) {
-                game.snake.direction = {0, 1}; // Move down
-                game.running = true;
-            }
-            if ((IsKeyPressed(KEY_LEFT) || IsKeyPressed(KEY_A)) && game.snake.direction.x != 1) {
-                game.snake.direction = {-1, 0}; // Move left
-                game.running = true;
-            }
-            if ((IsKeyPressed(KEY_RIGHT) || IsKeyPressed(KEY_D)) && game.snake.direction.x != -1) {
-                game.snake.direction = {1, 0}; // Move right
-                game.running = true;
-            }
+                // Draw game elements
+                ClearBackground(backgroundColor);
+                game.Draw(frame, alpha);
 
-            // Update game state if it's time based on the update interval
-            if (eventTriggered(game.GetUpdateInterval())) {
-                game.Update();
+                game.DrawHud(frame);
+                overlay.Draw(game.batchedSnake, game.cachedPlayfield, game.playfield.LastRepaint(), frame.lateMs, snakeColor);
             }
 
-            // Draw game elements
-            ClearBackground(backgroundColor);
-            DrawRectangleLinesEx(Rectangle{(float)offset - 5, (float)offset - 5, (float)cellSize * cellCount + 10, (float)cellSize * cellCount + 10}, 5, snakeColor);
-            DrawText(game.messages[game.currentMessageIndex].c_str(), offset-52, 20, 40, snakeColor);
-            DrawText(TextFormat("%i", game.score), offset+360, offset+cellSize*cellCount+10, 40, snakeColor);
-            game.Draw();
-
-            // Display player data after the game ends
-            if (!game.running) {
-                for (size_t i = 0; i < game.players.size(); ++i) {
-                    string difficulty = SpeedLevelToString(game.players[i].difficulty);
-                    DrawText(TextFormat("Player: %s - Score: %i - Difficulty: %s", game.players[i].name.c_str(), game.players[i].score, difficulty.c_str()), offset + 50, offset + 50 + i * 30, 20, snakeColor);
-                }
+            // End the drawing process (includes the wait for vsync)
+            {
+                PROFILE_SCOPE("EndDrawing");
+                EndDrawing();
             }
         }
-
-        // End the drawing process
-        EndDrawing();
     }
 
     // Cleanup resources before closing
@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>      // size_t for the mapping length
+#include <string>       // File paths
+
+// Read-only memory mapping of a whole file. The operating system pages the
+// bytes in on demand, so opening is constant time whatever the file size.
+class MappedFile {
+    private:
+        const unsigned char* bytes = nullptr; // Start of the mapping, null when closed
+        size_t length = 0; // Mapped size in bytes
+#ifdef _WIN32
+        void* fileHandle = nullptr; // HANDLE of the open file
+        void* mappingHandle = nullptr; // HANDLE of the file mapping
+#endif
+
+    public:
+        MappedFile() {}
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        // Maps a file, returns false if it cannot be opened or is empty.
+        bool Open(const std::string& path);
+
+        // Unmaps the file.
+        void Close();
+
+        // Returns whether a file is mapped.
+        bool IsOpen() const { return bytes != nullptr; }
+
+        // Returns the mapped bytes.
+        const unsigned char* Data() const { return bytes; }
+
+        // Returns the number of mapped bytes.
+        size_t Size() const { return length; }
+};
+
+// Function to create a directory if it does not exist yet, returns false on failure
+bool EnsureDirectory(const std::string& path);
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,229 @@
+#include "net_socket.h"
+
+#include <cerrno>       // EAGAIN/EWOULDBLOCK for non-blocking calls
+#include <cstring>      // memcpy for the frame header
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+#ifdef _WIN32
+
+typedef SOCKET NativeSocket;
+static const NativeSocket invalidSocket = INVALID_SOCKET;
+
+// Function to start Winsock once per process
+static void StartNetworking() {
+    static bool started = false;
+    if (!started) {
+        WSADATA data;
+        started = WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }
+}
+
+static bool WouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+static void CloseNative(NativeSocket socket) { closesocket(socket); }
+static void SetNonBlocking(NativeSocket socket) {
+    u_long enabled = 1;
+    ioctlsocket(socket, FIONBIO, &enabled);
+}
+static int PollSockets(pollfd* entries, size_t count, int timeoutMs) { return WSAPoll(entries, (ULONG)count, timeoutMs); }
+
+#else
+
+typedef int NativeSocket;
+static const NativeSocket invalidSocket = -1;
+
+// Function to keep a write to a closed peer from killing the process where neither
+// MSG_NOSIGNAL nor SO_NOSIGPIPE exists; send() then fails with EPIPE instead
+static void StartNetworking() {
+#if !defined(MSG_NOSIGNAL) && !defined(SO_NOSIGPIPE)
+    signal(SIGPIPE, SIG_IGN);
+#endif
+}
+static bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+static void CloseNative(NativeSocket socket) { close(socket); }
+static void SetNonBlocking(NativeSocket socket) { fcntl(socket, F_SETFL, fcntl(socket, F_GETFL, 0) | O_NONBLOCK); }
+static int PollSockets(pollfd* entries, size_t count, int timeoutMs) { return poll(entries, (nfds_t)count, timeoutMs); }
+
+#endif
+
+// Function to set up a connected socket: small frames go out immediately instead of waiting to coalesce
+// them (Nagle), and where the platform has SO_NOSIGPIPE, a send to a closed peer does not raise SIGPIPE
+static void SetConnectionOptions(NativeSocket socket) {
+    int enabled = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, (const char*)&enabled, sizeof(enabled));
+#ifdef SO_NOSIGPIPE
+    setsockopt(socket, SOL_SOCKET, SO_NOSIGPIPE, (const char*)&enabled, sizeof(enabled));
+#endif
+}
+
+TcpSocket TcpSocket::Listen(int port) {
+    StartNetworking();
+    NativeSocket socket = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (socket == invalidSocket) {
+        return TcpSocket();
+    }
+    int reuse = 1;
+    setsockopt(socket, SOL_SOCKET, SO_REUSEADDR, (const char*)&reuse, sizeof(reuse));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons((uint16_t)port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(socket, (const sockaddr*)&address, sizeof(address)) != 0 || listen(socket, 64) != 0) {
+        CloseNative(socket);
+        return TcpSocket();
+    }
+    SetNonBlocking(socket);
+    return TcpSocket((intptr_t)socket);
+}
+
+TcpSocket TcpSocket::Connect(const string& host, int port) {
+    StartNetworking();
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &found) != 0) {
+        return TcpSocket();
+    }
+    NativeSocket socket = ::socket(found->ai_family, found->ai_socktype, found->ai_protocol);
+    bool connected = socket != invalidSocket && connect(socket, found->ai_addr, (int)found->ai_addrlen) == 0;
+    freeaddrinfo(found);
+    if (!connected) {
+        if (socket != invalidSocket) {
+            CloseNative(socket);
+        }
+        return TcpSocket();
+    }
+    SetConnectionOptions(socket);
+    SetNonBlocking(socket);
+    return TcpSocket((intptr_t)socket);
+}
+
+TcpSocket TcpSocket::Accept() {
+    NativeSocket client = accept((NativeSocket)handle, nullptr, nullptr);
+    if (client == invalidSocket) {
+        return TcpSocket();
+    }
+    SetConnectionOptions(client);
+    SetNonBlocking(client);
+    return TcpSocket((intptr_t)client);
+}
+
+long TcpSocket::Send(const uint8_t* data, size_t size) {
+#ifdef MSG_NOSIGNAL
+    long sent = (long)send((NativeSocket)handle, (const char*)data, size, MSG_NOSIGNAL); // A closed peer must not raise SIGPIPE
+#else
+    long sent = (long)send((NativeSocket)handle, (const char*)data, (int)size, 0);
+#endif
+    if (sent < 0) {
+        return WouldBlock() ? 0 : -1;
+    }
+    return sent;
+}
+
+long TcpSocket::Receive(uint8_t* data, size_t size) {
+    long received = (long)recv((NativeSocket)handle, (char*)data, (int)size, 0);
+    if (received == 0) {
+        return -1; // Orderly shutdown by the peer
+    }
+    if (received < 0) {
+        return WouldBlock() ? 0 : -1;
+    }
+    return received;
+}
+
+void TcpSocket::Close() {
+    if (handle != -1) {
+        CloseNative((NativeSocket)handle);
+        handle = -1;
+    }
+}
+
+void WaitForInput(const vector<intptr_t>& handles, int timeoutMs) {
+    vector<pollfd> entries(handles.size());
+    for (size_t i = 0; i < handles.size(); i++) {
+        entries[i].fd = (NativeSocket)handles[i];
+        entries[i].events = POLLIN;
+        entries[i].revents = 0;
+    }
+    PollSockets(entries.data(), entries.size(), timeoutMs);
+}
+
+void NetConnection::Queue(uint8_t type, const uint8_t* payload, size_t size) {
+    uint32_t frameSize = (uint32_t)size + 1;
+    uint8_t header[5];
+    memcpy(header, &frameSize, sizeof(frameSize));
+    header[4] = type;
+    outbound.insert(outbound.end(), header, header + sizeof(header));
+    outbound.insert(outbound.end(), payload, payload + size);
+}
+
+bool NetConnection::Flush() {
+    while (outboundSent < outbound.size()) {
+        long sent = socket.Send(outbound.data() + outboundSent, outbound.size() - outboundSent);
+        if (sent < 0) {
+            return false;
+        }
+        if (sent == 0) {
+            break; // The kernel buffer is full; the rest goes out on a later flush
+        }
+        outboundSent += (size_t)sent;
+    }
+    if (outboundSent == outbound.size()) {
+        outbound.clear(); // Keeps the capacity, so steady traffic stops allocating
+        outboundSent = 0;
+    }
+    return true;
+}
+
+bool NetConnection::Pump() {
+    uint8_t chunk[16384];
+    for (;;) {
+        long received = socket.Receive(chunk, sizeof(chunk));
+        if (received < 0) {
+            return false;
+        }
+        if (received == 0) {
+            return true;
+        }
+        inbound.insert(inbound.end(), chunk, chunk + received);
+    }
+}
+
+bool NetConnection::NextMessage(uint8_t& type, vector<uint8_t>& payload) {
+    size_t available = inbound.size() - inboundRead;
+    uint32_t frameSize = 0;
+    if (available < 5) {
+        return false;
+    }
+    memcpy(&frameSize, inbound.data() + inboundRead, sizeof(frameSize));
+    if (frameSize == 0 || available < 4 + (size_t)frameSize) {
+        return false; // Incomplete (an empty frame has no type and only comes from a broken peer)
+    }
+    type = inbound[inboundRead + 4];
+    payload.assign(inbound.begin() + inboundRead + 5, inbound.begin() + inboundRead + 4 + frameSize);
+    inboundRead += 4 + (size_t)frameSize;
+    if (inboundRead == inbound.size()) {
+        inbound.clear();
+        inboundRead = 0;
+    } else if (inboundRead > 65536) {
+        inbound.erase(inbound.begin(), inbound.begin() + inboundRead); // A partial frame keeps arriving behind full ones
+        inboundRead = 0;
+    }
+    return true;
+}
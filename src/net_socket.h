@@ -0,0 +1,91 @@
+#ifndef NET_SOCKET_H
+#define NET_SOCKET_H
+
+#include <cstddef>      // size_t for buffer sizes
+#include <cstdint>      // Fixed-width integer types for the frame header
+#include <string>       // Host names
+#include <vector>       // Inbound and outbound buffers
+
+// Non-blocking TCP socket. The handle is an int on POSIX and a SOCKET on
+// Windows, both stored as intptr_t so this header needs no system includes.
+class TcpSocket {
+    private:
+        intptr_t handle = -1; // Open socket, -1 when closed
+
+    public:
+        TcpSocket() {}
+        explicit TcpSocket(intptr_t handle) : handle(handle) {}
+        ~TcpSocket() { Close(); }
+
+        TcpSocket(const TcpSocket&) = delete;
+        TcpSocket& operator=(const TcpSocket&) = delete;
+        TcpSocket(TcpSocket&& other) : handle(other.handle) { other.handle = -1; }
+        TcpSocket& operator=(TcpSocket&& other) {
+            if (this != &other) {
+                Close();
+                handle = other.handle;
+                other.handle = -1;
+            }
+            return *this;
+        }
+
+        // Listens on 127.0.0.1:port; the result is closed on failure.
+        static TcpSocket Listen(int port);
+
+        // Connects to host:port (blocking until connected); the result is closed on failure.
+        static TcpSocket Connect(const std::string& host, int port);
+
+        // Returns a pending connection of a listening socket, or a closed socket when there is none.
+        TcpSocket Accept();
+
+        // Sends what the kernel accepts now; returns the bytes sent, or -1 once the connection is broken.
+        long Send(const uint8_t* data, size_t size);
+
+        // Reads what has arrived; returns the bytes read, 0 when nothing is pending, or -1 once the peer closed.
+        long Receive(uint8_t* data, size_t size);
+
+        // Closes the socket.
+        void Close();
+
+        // Returns whether the socket is open.
+        bool IsOpen() const { return handle != -1; }
+
+        // Returns the system handle.
+        intptr_t Handle() const { return handle; }
+};
+
+// Function to wait until one of the sockets has input, or 'timeoutMs' passes
+void WaitForInput(const std::vector<intptr_t>& handles, int timeoutMs);
+
+// Message stream over a TcpSocket. Every message travels as one frame:
+// uint32_t size of the rest, uint8_t type, then the payload.
+class NetConnection {
+    private:
+        std::vector<uint8_t> inbound; // Received bytes not yet returned by NextMessage()
+        size_t inboundRead = 0; // Start of the unread part of 'inbound'
+        std::vector<uint8_t> outbound; // Queued bytes not yet accepted by the kernel
+        size_t outboundSent = 0; // Start of the unsent part of 'outbound'
+
+    public:
+        TcpSocket socket; // The connection itself
+
+        explicit NetConnection(TcpSocket socket) : socket(std::move(socket)) {}
+
+        // Queues one message.
+        void Queue(uint8_t type, const std::vector<uint8_t>& payload) { Queue(type, payload.data(), payload.size()); }
+        void Queue(uint8_t type, const uint8_t* payload, size_t size);
+
+        // Sends queued bytes without blocking, returns false once the connection is broken.
+        bool Flush();
+
+        // Returns the number of queued bytes the peer has not taken yet.
+        size_t Backlog() const { return outbound.size() - outboundSent; }
+
+        // Reads what has arrived without blocking, returns false once the peer closed.
+        bool Pump();
+
+        // Takes the next complete message, returns false when none has fully arrived.
+        bool NextMessage(uint8_t& type, std::vector<uint8_t>& payload);
+};
+
+#endif // NET_SOCKET_H
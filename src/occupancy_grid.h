@@ -0,0 +1,126 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <algorithm>    // std::copy for clearing the grid
+#include <cstdint>      // Fixed-width integer type for the per-cell counters
+#include <vector>       // The vector container backing the grid
+
+#include "board.h"
+#include "cell.h"
+#include "free_cell_set.h"
+
+// Byte grid of one counter per board cell. Each counter holds how many snake
+// segments sit on that cell, so membership and self-collision tests are a
+// single array lookup instead of a body scan.
+// The grid also keeps the set of empty cells inside the food spawn area, so
+// picking a spawn cell never has to retry.
+// Walls of a level are counted as one permanent segment, so a head entering a
+// wall is caught by the same lookup as a head entering the body, and walls
+// never enter the spawn set.
+template <typename BoardT>
+class OccupancyGrid {
+    private:
+        BoardT board; // Geometry of the board (empty for compile-time boards)
+        std::vector<uint8_t> cells; // Row-major segment counters
+        std::vector<uint8_t> walls; // Row-major counters of an empty board: 1 on walls, 0 elsewhere
+        int wallCount = 0; // Number of wall cells
+        int spawnMin = 0; // First row/column of the spawn area
+        int spawnMax; // Last row/column of the spawn area
+        FreeCellSet freeSpawnCells; // Empty cells inside the spawn area
+
+        // Refills the spawn set from the counters.
+        void RebuildSpawnCells() {
+            const int size = board.CellCount();
+            freeSpawnCells.Clear();
+            for (int y = spawnMin; y <= spawnMax; y++) {
+                for (int x = spawnMin; x <= spawnMax; x++) {
+                    if (cells[y * size + x] == 0) {
+                        freeSpawnCells.Insert(y * size + x);
+                    }
+                }
+            }
+        }
+
+    public:
+        explicit OccupancyGrid(BoardT board)
+            : board(board), cells(board.Area(), 0), walls(board.Area(), 0), spawnMax(board.CellCount() - 1), freeSpawnCells(board.Area()) {
+            RebuildSpawnCells();
+        }
+
+        // Returns the board geometry.
+        const BoardT& GetBoard() const { return board; }
+
+        // Returns whether the cell lies on the board.
+        bool Contains(Cell cell) const { return board.Contains(cell); }
+
+        // Returns the row-major index of an on-board cell.
+        int Index(Cell cell) const { return board.Index(cell); }
+
+        // Returns the cell at a row-major index.
+        Cell CellAt(int index) const { return board.CellAt(index); }
+
+        // Returns how many segments currently sit on an on-board cell.
+        int Count(Cell cell) const { return cells[Index(cell)]; }
+
+        // Returns whether any segment sits on an on-board cell.
+        bool IsOccupied(Cell cell) const { return cells[Index(cell)] != 0; }
+
+        // Returns whether an on-board cell is a wall.
+        bool IsWall(Cell cell) const { return walls[Index(cell)] != 0; }
+
+        // Returns the number of wall cells.
+        int WallCount() const { return wallCount; }
+
+        // Returns whether the cell lies inside the spawn area.
+        bool InSpawnArea(Cell cell) const {
+            return cell.x >= spawnMin && cell.x <= spawnMax && cell.y >= spawnMin && cell.y <= spawnMax;
+        }
+
+        // Records a segment entering an on-board cell.
+        void Occupy(Cell cell) {
+            int index = Index(cell);
+            if (cells[index]++ == 0 && InSpawnArea(cell)) {
+                freeSpawnCells.Erase(index);
+            }
+        }
+
+        // Records a segment leaving an on-board cell.
+        void Vacate(Cell cell) {
+            int index = Index(cell);
+            if (--cells[index] == 0 && InSpawnArea(cell)) {
+                freeSpawnCells.Insert(index);
+            }
+        }
+
+        // Marks every cell but the walls as empty.
+        void Clear() {
+            std::copy(walls.begin(), walls.end(), cells.begin());
+            RebuildSpawnCells();
+        }
+
+        // Replaces the walls with a row-major bitmap (bit i & 7 of byte i / 8 set for cell i; null for
+        // none) and clears the grid.
+        void SetWalls(const uint8_t* bits) {
+            wallCount = 0;
+            for (int i = 0; i < board.Area(); i++) {
+                walls[i] = bits != nullptr ? (bits[i >> 3] >> (i & 7)) & 1 : 0;
+                wallCount += walls[i];
+            }
+            Clear();
+        }
+
+        // Restricts the spawn area to cells at least 'margin' cells away from every edge.
+        void SetSpawnMargin(int margin) {
+            spawnMin = margin;
+            spawnMax = board.CellCount() - 1 - margin;
+            RebuildSpawnCells();
+        }
+
+        // Returns the empty cells inside the spawn area.
+        const FreeCellSet& FreeSpawnCells() const { return freeSpawnCells; }
+
+        // Restores the order of the spawn set saved from an identical grid, so later spawns repeat exactly.
+        void RestoreFreeSpawnCells(const int* indices, int count) { freeSpawnCells.Assign(indices, count); }
+};
+
+#endif // OCCUPANCY_GRID_H
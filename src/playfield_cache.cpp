@@ -0,0 +1,37 @@
+#include "playfield_cache.h"
+
+#include <rlgl.h>       // Blend factors for presenting the texture unblended
+
+void PlayfieldCache::Remember(const FrameSnapshot& frame, const PlayfieldStyle& frameStyle, int frameSprite) {
+    painted = true;
+    version = frame.version;
+    tick = frame.tick;
+    head = frame.body.front();
+    tail = frame.body.back();
+    food = frame.food;
+    foodPlaced = frame.foodPlaced;
+    style = frameStyle;
+    foodSprite = frameSprite;
+}
+
+void PlayfieldCache::Draw(int x, int y) const {
+    if (!loaded) {
+        return;
+    }
+    // The texture's colors are final, but its alpha was reduced wherever the food was
+    // blended in; copying the colors as they are keeps those pixels from blending twice
+    rlSetBlendFactors(RL_ONE, RL_ZERO, RL_FUNC_ADD);
+    BeginBlendMode(BLEND_CUSTOM);
+    // Render textures are stored upside down, hence the negative source height
+    Rectangle source = {0, 0, (float)target.texture.width, -(float)target.texture.height};
+    DrawTextureRec(target.texture, source, Vector2{(float)x, (float)y}, WHITE);
+    EndBlendMode();
+}
+
+void PlayfieldCache::Release() {
+    if (loaded) {
+        UnloadRenderTexture(target);
+        loaded = false;
+    }
+    painted = false;
+}
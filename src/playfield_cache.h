@@ -0,0 +1,153 @@
+#ifndef PLAYFIELD_CACHE_H
+#define PLAYFIELD_CACHE_H
+
+#include <raylib.h>     // RenderTexture2D and drawing
+#include <cstdint>      // Snapshot versions and ticks
+#include <vector>       // Wall cells
+
+#include "sim_thread.h"
+
+// Colors the playfield was painted with; any change repaints it whole.
+struct PlayfieldStyle {
+    Color background; // Board background
+    Color snake; // Snake and border color
+
+    bool operator==(const PlayfieldStyle& other) const {
+        return ColorToInt(background) == ColorToInt(other.background) && ColorToInt(snake) == ColorToInt(other.snake);
+    }
+};
+
+// The board, its border, the snake and the food painted into a render
+// texture. A frame whose snapshot follows the painted one by a single tick
+// repaints only the cells that tick changed (new head, vacated tail, old and
+// new food); a frame with no new tick repaints nothing, or only the food when
+// its sprite changed, and just presents the texture. Anything else (a
+// restart, skipped ticks, new colors) repaints the whole board. The snake is
+// drawn at its tick positions, without interpolation.
+// Needs a window; must be destroyed before CloseWindow().
+class PlayfieldCache {
+    private:
+        RenderTexture2D target; // Painted playfield, valid while 'loaded'
+        bool loaded = false; // Whether 'target' holds a texture
+        bool painted = false; // Whether the fields below describe the texture content
+        int cellSize; // Cell side in pixels
+        int cellsPerSide; // Board side in cells
+        int border; // Border thickness in pixels, around the cells
+        uint64_t version = 0; // Snapshot the texture shows
+        uint64_t tick = 0; // Tick of that snapshot
+        Cell head = {0, 0}; // Painted head
+        Cell tail = {0, 0}; // Painted tail
+        Cell food = {0, 0}; // Painted food, if 'foodPlaced'
+        bool foodPlaced = false; // Whether food is painted
+        PlayfieldStyle style = {BLANK, BLANK}; // Style the texture was painted with
+        int foodSprite = -1; // Food variant painted
+        int lastRepaint = 0; // Cells repainted by the last Update(), -1 for the whole board
+        std::vector<Cell> walls; // Wall cells of the level, painted with every full repaint
+
+        // Returns the top-left pixel of a cell inside the texture.
+        Vector2 CellOrigin(Cell cell) const {
+            return Vector2{(float)(border + cell.x * cellSize), (float)(border + cell.y * cellSize)};
+        }
+
+        // Remembers what 'frame' painted.
+        void Remember(const FrameSnapshot& frame, const PlayfieldStyle& frameStyle, int frameSprite);
+
+    public:
+        PlayfieldCache(int cellSize, int cellsPerSide, int border)
+            : cellSize(cellSize), cellsPerSide(cellsPerSide), border(border) {}
+        ~PlayfieldCache() { Release(); }
+
+        PlayfieldCache(const PlayfieldCache&) = delete;
+        PlayfieldCache& operator=(const PlayfieldCache&) = delete;
+
+        // Brings the texture up to date with 'frame', its food drawn as variant 'frameSprite' (-1 while the
+        // atlas loads). drawFood(position) and drawSegment(position) paint one cell whose top-left corner is
+        // 'position' in texture coordinates.
+        template <typename DrawFoodFn, typename DrawSegmentFn>
+        void Update(const FrameSnapshot& frame, const PlayfieldStyle& frameStyle, int frameSprite, DrawFoodFn&& drawFood, DrawSegmentFn&& drawSegment) {
+            bool sameSnapshot = painted && frame.version == version && frameStyle == style;
+            if (sameSnapshot && frameSprite == foodSprite) {
+                lastRepaint = 0;
+                return;
+            }
+            if (!loaded) {
+                int side = cellsPerSide * cellSize + 2 * border;
+                target = LoadRenderTexture(side, side);
+                loaded = true;
+            }
+            // The previous snapshot is what is painted, so one tick changed at most four cells
+            bool nextTick = painted && frameStyle == style && frame.continuous && frame.tick == tick + 1 &&
+                            !frame.previousBody.empty() && frame.previousBody.front() == head && frame.previousBody.back() == tail;
+            BeginTextureMode(target);
+            if (sameSnapshot || nextTick) {
+                Cell dirty[4];
+                int count = 0;
+                auto mark = [&](Cell cell) {
+                    for (int i = 0; i < count; i++) {
+                        if (dirty[i] == cell) {
+                            return;
+                        }
+                    }
+                    dirty[count++] = cell;
+                };
+                if (nextTick) {
+                    mark(frame.body.front());
+                    mark(tail);
+                    if (foodPlaced) {
+                        mark(food);
+                    }
+                }
+                if (frame.foodPlaced) {
+                    mark(frame.food);
+                }
+                for (int i = 0; i < count; i++) {
+                    Vector2 origin = CellOrigin(dirty[i]);
+                    DrawRectangle((int)origin.x, (int)origin.y, cellSize, cellSize, frameStyle.background);
+                    // Food is never under the body, and the old tail or old food can only still be covered as the head or new tail
+                    if (dirty[i] == frame.body.front() || dirty[i] == frame.body.back()) {
+                        drawSegment(origin);
+                    } else if (frame.foodPlaced && dirty[i] == frame.food) {
+                        drawFood(origin);
+                    }
+                }
+                lastRepaint = count;
+            } else {
+                ClearBackground(frameStyle.background);
+                int side = cellsPerSide * cellSize + 2 * border;
+                DrawRectangleLinesEx(Rectangle{0, 0, (float)side, (float)side}, (float)border, frameStyle.snake);
+                for (const Cell& wall : walls) {
+                    Vector2 origin = CellOrigin(wall);
+                    DrawRectangle((int)origin.x, (int)origin.y, cellSize, cellSize, frameStyle.snake);
+                }
+                if (frame.foodPlaced) {
+                    drawFood(CellOrigin(frame.food));
+                }
+                for (const Cell& segment : frame.body) {
+                    drawSegment(CellOrigin(segment));
+                }
+                lastRepaint = -1;
+            }
+            EndTextureMode();
+            Remember(frame, frameStyle, frameSprite);
+        }
+
+        // Presents the texture with its top-left corner (the outer edge of the border) at (x, y).
+        void Draw(int x, int y) const;
+
+        // Returns the cells repainted by the last Update(), -1 if it repainted the whole board.
+        int LastRepaint() const { return lastRepaint; }
+
+        // Replaces the wall cells (they never change during a run, so only full repaints draw them).
+        void SetWalls(const std::vector<Cell>& cells) {
+            walls = cells;
+            painted = false;
+        }
+
+        // Forces the next Update() to repaint the whole board.
+        void Invalidate() { painted = false; }
+
+        // Unloads the texture.
+        void Release();
+};
+
+#endif // PLAYFIELD_CACHE_H
@@ -0,0 +1,118 @@
+#include "profiler.h"
+
+#include <algorithm>    // std::nth_element for percentiles
+#include <chrono>       // Steady clock timestamps
+#include <cstdio>       // fprintf for the trace file
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+atomic<bool> Profiler::enabled(false);
+
+double ProfileStats::PercentileMs(double p) const {
+    if (window.empty()) {
+        return 0.0;
+    }
+    vector<uint64_t> sorted(window);
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index] / 1e6;
+}
+
+Profiler& Profiler::Get() {
+    static Profiler profiler;
+    return profiler;
+}
+
+uint64_t Profiler::Now() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+Profiler::ThreadBuffer& Profiler::CurrentThread() {
+    // The registry keeps the buffer alive after its thread exits, until its samples are collected
+    thread_local shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = make_shared<ThreadBuffer>();
+        lock_guard<mutex> lock(threadsMutex);
+        buffer->id = (uint32_t)threads.size() + 1;
+        buffer->name = "thread " + to_string(buffer->id);
+        threads.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Profiler::SetThreadName(const string& name) {
+    ThreadBuffer& buffer = CurrentThread();
+    lock_guard<mutex> lock(threadsMutex);
+    buffer.name = name;
+}
+
+void Profiler::Record(const char* name, uint64_t start, uint64_t end) {
+    ThreadBuffer& buffer = CurrentThread();
+    if (!buffer.samples.TryPush(ProfileSample{name, start, end - start, buffer.id})) {
+        buffer.dropped.fetch_add(1, memory_order_relaxed);
+    }
+}
+
+void Profiler::Collect() {
+    lock_guard<mutex> lock(threadsMutex);
+    dropped = 0;
+    for (const shared_ptr<ThreadBuffer>& buffer : threads) {
+        ProfileSample sample;
+        while (buffer->samples.TryPop(sample)) {
+            ProfileStats& scope = stats[sample.name];
+            if (scope.window.size() < windowSize) {
+                scope.window.push_back(sample.duration);
+            } else {
+                scope.window[scope.next] = sample.duration;
+            }
+            scope.next = (scope.next + 1) % windowSize;
+            scope.count++;
+            if (recording && trace.size() < maxTraceSamples) {
+                trace.push_back(sample);
+            }
+        }
+        dropped += buffer->dropped.load(memory_order_relaxed);
+    }
+}
+
+const ProfileStats* Profiler::Find(const string& name) const {
+    auto found = stats.find(name);
+    return found == stats.end() ? nullptr : &found->second;
+}
+
+void Profiler::StartTrace() {
+    trace.clear();
+    recording = true;
+}
+
+bool Profiler::StopTrace(const string& path) {
+    recording = false;
+    FILE* file = fopen(path.c_str(), "w");
+    if (file == nullptr) {
+        return false;
+    }
+    fprintf(file, "{\"traceEvents\":[\n");
+    const char* separator = ""; // No comma before the first event
+    {
+        lock_guard<mutex> lock(threadsMutex);
+        for (const shared_ptr<ThreadBuffer>& buffer : threads) {
+            fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                    separator, buffer->id, buffer->name.c_str());
+            separator = ",\n";
+        }
+    }
+    // Complete ("X") events take microseconds relative to the first sample
+    uint64_t origin = trace.empty() ? 0 : trace[0].start;
+    for (const ProfileSample& sample : trace) {
+        origin = min(origin, sample.start);
+    }
+    for (const ProfileSample& sample : trace) {
+        fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", separator,
+                sample.name, sample.thread, (sample.start - origin) / 1e3, sample.duration / 1e3);
+        separator = ",\n";
+    }
+    fprintf(file, "\n]}\n");
+    trace.clear();
+    trace.shrink_to_fit();
+    return fclose(file) == 0;
+}
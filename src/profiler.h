@@ -0,0 +1,132 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>       // The global enable flag
+#include <cstdint>      // Nanosecond timestamps
+#include <map>          // Statistics per scope name
+#include <memory>       // Shared ownership of the per-thread buffers
+#include <mutex>        // Guards thread registration
+#include <string>       // Scope and thread names
+#include <vector>       // Sample windows and the trace
+
+#include "spsc_queue.h"
+
+// Scoped hot-path timers. PROFILE_SCOPE("name") times the rest of the
+// enclosing block. Every thread pushes its samples into its own lock-free
+// queue; the render thread drains them once per frame (Collect()) into
+// rolling p50/p99 statistics and, while recording, into a Chrome trace
+// (chrome://tracing or ui.perfetto.dev).
+// While profiling is disabled a scope costs one relaxed atomic load; building
+// with -DSNAKE_NO_PROFILER removes the scopes entirely.
+
+// One timed scope
+struct ProfileSample {
+    const char* name; // Scope name, a string literal
+    uint64_t start; // Profiler::Now() at scope entry, in nanoseconds
+    uint64_t duration; // Nanoseconds spent in the scope
+    uint32_t thread; // Small id of the recording thread
+};
+
+// Rolling distribution of one scope's durations
+struct ProfileStats {
+    std::vector<uint64_t> window; // Most recent durations, a ring
+    size_t next = 0; // Ring slot written next
+    uint64_t count = 0; // Samples seen since the profiler was enabled
+
+    // Returns the duration at percentile p (0..1) of the window, in milliseconds.
+    double PercentileMs(double p) const;
+};
+
+class Profiler {
+    private:
+        static const size_t windowSize = 240; // Samples per scope kept for percentiles (4 s at 60 FPS)
+        static const size_t maxTraceSamples = 1 << 20; // Recording stops growing past this many samples
+
+        // Samples of one thread, written by that thread only.
+        struct ThreadBuffer {
+            SpscQueue<ProfileSample, 4096> samples;
+            std::atomic<uint64_t> dropped; // Samples lost to a full queue
+            uint32_t id; // Small id used in traces
+            std::string name; // Thread name shown in traces
+            ThreadBuffer() : dropped(0), id(0) {}
+        };
+
+        std::mutex threadsMutex; // Guards 'threads' (taken once per thread and by Collect())
+        std::vector<std::shared_ptr<ThreadBuffer>> threads; // Every thread that recorded a sample
+        std::map<std::string, ProfileStats> stats; // Per-scope statistics, render thread only
+        std::vector<ProfileSample> trace; // Samples of the recording in progress
+        bool recording = false; // Whether Collect() also appends to 'trace'
+        uint64_t dropped = 0; // Samples lost across all threads
+
+        Profiler() {}
+        // Returns the calling thread's buffer, registering it on first use.
+        ThreadBuffer& CurrentThread();
+
+    public:
+        static std::atomic<bool> enabled; // Scopes record only while set
+
+        // Returns the process-wide profiler.
+        static Profiler& Get();
+
+        // Returns a monotonic timestamp in nanoseconds.
+        static uint64_t Now();
+
+        // Turns recording on or off for every thread.
+        static void SetEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+
+        // Names the calling thread in traces.
+        void SetThreadName(const std::string& name);
+
+        // Called by ProfileScope: queues a sample from the calling thread.
+        void Record(const char* name, uint64_t start, uint64_t end);
+
+        // Drains every thread's samples into the statistics (and the trace); call once per frame.
+        void Collect();
+
+        // Returns the statistics of a scope, or null if it never ran.
+        const ProfileStats* Find(const std::string& name) const;
+
+        // Returns every scope's statistics, ordered by name.
+        const std::map<std::string, ProfileStats>& AllStats() const { return stats; }
+
+        // Returns the number of samples lost to full queues.
+        uint64_t Dropped() const { return dropped; }
+
+        // Starts collecting samples into a trace.
+        void StartTrace();
+
+        // Returns whether a trace is being recorded.
+        bool IsTracing() const { return recording; }
+
+        // Stops recording and writes the trace as Chrome trace-event JSON, returns false on I/O errors.
+        bool StopTrace(const std::string& path);
+};
+
+// Times the enclosing block; see PROFILE_SCOPE.
+class ProfileScope {
+    private:
+        const char* name; // Scope name, null while profiling is disabled
+        uint64_t start; // Entry timestamp
+
+    public:
+        explicit ProfileScope(const char* scopeName)
+            : name(Profiler::enabled.load(std::memory_order_relaxed) ? scopeName : nullptr), start(name ? Profiler::Now() : 0) {}
+        ~ProfileScope() {
+            if (name != nullptr) {
+                Profiler::Get().Record(name, start, Profiler::Now());
+            }
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#ifdef SNAKE_NO_PROFILER
+#define PROFILE_SCOPE(name) ((void)0)
+#else
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,256 @@
+#include "replay.h"
+
+#include <cstdio>       // fopen/fwrite for saving
+#include <cstring>      // memcpy/memcmp for the packed layout
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Function to append the raw bytes of a value to a buffer
+template <typename T>
+static void AppendBytes(vector<uint8_t>& buffer, const T& value) {
+    const uint8_t* bytes = (const uint8_t*)&value;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+// Function to round an offset up to the next multiple of 8
+static uint64_t AlignTo8(uint64_t offset) {
+    return (offset + 7) & ~(uint64_t)7;
+}
+
+void ReplayWriter::Begin(uint64_t seed, SpeedLevel level, int boardSize, uint32_t keyframeInterval) {
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "SNKR", 4);
+    header.version = replayVersion;
+    header.boardSize = (uint16_t)boardSize;
+    header.seed = seed;
+    header.difficulty = (uint8_t)level;
+    header.keyframeInterval = keyframeInterval > 0 ? keyframeInterval : defaultKeyframeInterval;
+    inputs.clear();
+    entries.clear();
+    keyframes.clear();
+    deltaBase = 0;
+}
+
+void ReplayWriter::AddKeyframe(const SimulationState& state) {
+    // Keep every keyframe 8-byte aligned inside its section
+    keyframes.resize(AlignTo8(keyframes.size()), 0);
+
+    ReplayKeyframeEntry entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.tick = header.tickCount;
+    entry.inputPosition = (uint32_t)inputs.size();
+    entry.deltaBase = deltaBase;
+    entry.offset = keyframes.size();
+    entries.push_back(entry);
+
+    ReplayKeyframeHeader frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.rngState = state.rngState;
+    frame.score = state.score;
+    frame.lastScore = state.lastScore;
+    frame.foodEaten = state.foodEaten;
+    frame.directionX = (int16_t)state.direction.x;
+    frame.directionY = (int16_t)state.direction.y;
+    frame.foodX = (int16_t)state.foodPosition.x;
+    frame.foodY = (int16_t)state.foodPosition.y;
+    frame.speedLevel = (uint8_t)state.speedLevel;
+    frame.newDifficulty = (uint8_t)state.newDifficulty;
+    frame.flags = (state.difficultyHasChanged ? KEYFRAME_DIFFICULTY_CHANGED : 0) |
+                  (state.addSegment ? KEYFRAME_ADD_SEGMENT : 0) |
+                  (state.foodPlaced ? KEYFRAME_FOOD_PLACED : 0) |
+                  (state.running ? KEYFRAME_RUNNING : 0);
+    frame.bodyLength = (uint32_t)state.body.size();
+    frame.freeCellCount = (uint32_t)state.freeSpawnCells.size();
+    AppendBytes(keyframes, frame);
+    for (const Cell& cell : state.body) {
+        AppendBytes(keyframes, PackedCell{(uint16_t)cell.x, (uint16_t)cell.y});
+    }
+    for (int index : state.freeSpawnCells) {
+        AppendBytes(keyframes, (uint32_t)index);
+    }
+}
+
+void ReplayWriter::AddInput(Input input) {
+    if (input != Input::NONE) {
+        // Most ticks carry no input, so only changes are stored, as tick deltas
+        uint64_t value = ((uint64_t)(header.tickCount - deltaBase) << 3) | (uint64_t)input;
+        while (value >= 0x80) {
+            inputs.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        inputs.push_back((uint8_t)value);
+        deltaBase = header.tickCount;
+    }
+    header.tickCount++;
+}
+
+bool ReplayWriter::Save(const string& path) const {
+    ReplayHeader out = header;
+    out.keyframeCount = (uint32_t)entries.size();
+    out.inputOffset = sizeof(ReplayHeader);
+    out.inputSize = inputs.size();
+    out.keyframeIndexOffset = AlignTo8(out.inputOffset + out.inputSize);
+    uint64_t keyframeOffset = AlignTo8(out.keyframeIndexOffset + entries.size() * sizeof(ReplayKeyframeEntry));
+
+    vector<uint8_t> file;
+    file.reserve(keyframeOffset + keyframes.size());
+    AppendBytes(file, out);
+    file.insert(file.end(), inputs.begin(), inputs.end());
+    file.resize(out.keyframeIndexOffset, 0);
+    for (ReplayKeyframeEntry entry : entries) {
+        entry.offset += keyframeOffset; // Make keyframe offsets absolute
+        AppendBytes(file, entry);
+    }
+    file.resize(keyframeOffset, 0);
+    file.insert(file.end(), keyframes.begin(), keyframes.end());
+
+    FILE* stream = fopen(path.c_str(), "wb");
+    if (stream == nullptr) {
+        return false;
+    }
+    bool written = fwrite(file.data(), 1, file.size(), stream) == file.size();
+    return fclose(stream) == 0 && written;
+}
+
+ReplayInputCursor::ReplayInputCursor(const uint8_t* position, const uint8_t* end, uint32_t deltaBase)
+    : position(position), end(end), nextTick(0), nextInput(Input::NONE) {
+    Advance(deltaBase);
+}
+
+void ReplayInputCursor::Advance(uint32_t base) {
+    uint64_t value = 0;
+    int shift = 0;
+    while (position < end && shift < 64) {
+        uint8_t byte = *position++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        shift += 7;
+        if ((byte & 0x80) == 0) {
+            nextTick = base + (uint32_t)(value >> 3);
+            nextInput = (Input)(value & 7);
+            return;
+        }
+    }
+    nextInput = Input::NONE; // Exhausted (or truncated) stream
+}
+
+Input ReplayInputCursor::InputAt(uint32_t tick) {
+    if (nextInput == Input::NONE || tick != nextTick) {
+        return Input::NONE;
+    }
+    Input input = nextInput;
+    Advance(nextTick);
+    return input;
+}
+
+bool ReplayReader::Open(const void* bytes, size_t length) {
+    data = nullptr;
+    size = 0;
+    if (bytes == nullptr || length < sizeof(ReplayHeader)) {
+        return false;
+    }
+    memcpy(&header, bytes, sizeof(header));
+    if (memcmp(header.magic, "SNKR", 4) != 0 || header.version != replayVersion || header.keyframeCount == 0 ||
+        !ValidBoardSize(header.boardSize) || header.difficulty > (uint8_t)SpeedLevel::VERY_FAST) {
+        return false;
+    }
+    if (header.inputOffset > length || header.inputSize > length - header.inputOffset) {
+        return false;
+    }
+    uint64_t indexSize = (uint64_t)header.keyframeCount * sizeof(ReplayKeyframeEntry);
+    if (header.keyframeIndexOffset > length || indexSize > length - header.keyframeIndexOffset) {
+        return false;
+    }
+    data = (const uint8_t*)bytes;
+    size = length;
+    for (uint32_t i = 0; i < header.keyframeCount; i++) {
+        ReplayKeyframeEntry entry = Keyframe(i);
+        if (entry.offset > length || sizeof(ReplayKeyframeHeader) > length - entry.offset ||
+            entry.inputPosition > header.inputSize || entry.tick > header.tickCount ||
+            (i == 0 && entry.tick != 0) || (i > 0 && entry.tick <= Keyframe(i - 1).tick)) {
+            data = nullptr;
+            size = 0;
+            return false;
+        }
+    }
+    return true;
+}
+
+ReplayKeyframeEntry ReplayReader::Keyframe(uint32_t index) const {
+    ReplayKeyframeEntry entry;
+    memcpy(&entry, data + header.keyframeIndexOffset + (uint64_t)index * sizeof(ReplayKeyframeEntry), sizeof(entry));
+    return entry;
+}
+
+uint32_t ReplayReader::FindKeyframe(uint32_t tick) const {
+    // Binary search for the last entry whose tick is not after 'tick'
+    uint32_t low = 0;
+    uint32_t high = header.keyframeCount;
+    while (high - low > 1) {
+        uint32_t middle = low + (high - low) / 2;
+        if (Keyframe(middle).tick <= tick) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+bool ReplayReader::ReadKeyframe(uint32_t index, SimulationState& state) const {
+    ReplayKeyframeEntry entry = Keyframe(index);
+    ReplayKeyframeHeader frame;
+    memcpy(&frame, data + entry.offset, sizeof(frame));
+    uint64_t payload = (uint64_t)frame.bodyLength * sizeof(PackedCell) + (uint64_t)frame.freeCellCount * sizeof(uint32_t);
+    uint64_t payloadOffset = entry.offset + sizeof(frame);
+    const int boardSize = header.boardSize;
+    const uint32_t area = (uint32_t)(boardSize * boardSize);
+    if (payload > size - payloadOffset || frame.bodyLength == 0 || frame.bodyLength > area || frame.freeCellCount > area ||
+        frame.speedLevel > (uint8_t)SpeedLevel::VERY_FAST || frame.newDifficulty > (uint8_t)SpeedLevel::VERY_FAST ||
+        (unsigned)frame.foodX >= (unsigned)boardSize || (unsigned)frame.foodY >= (unsigned)boardSize) {
+        return false;
+    }
+    state.rngState = frame.rngState;
+    state.score = frame.score;
+    state.lastScore = frame.lastScore;
+    state.foodEaten = frame.foodEaten;
+    state.direction = Cell{frame.directionX, frame.directionY};
+    state.foodPosition = Cell{frame.foodX, frame.foodY};
+    state.speedLevel = (SpeedLevel)frame.speedLevel;
+    state.newDifficulty = (SpeedLevel)frame.newDifficulty;
+    state.difficultyHasChanged = (frame.flags & KEYFRAME_DIFFICULTY_CHANGED) != 0;
+    state.addSegment = (frame.flags & KEYFRAME_ADD_SEGMENT) != 0;
+    state.foodPlaced = (frame.flags & KEYFRAME_FOOD_PLACED) != 0;
+    state.running = (frame.flags & KEYFRAME_RUNNING) != 0;
+
+    // LoadState() trusts the cells it is given, so every one must be on the board: body cells
+    // distinct, spawn set entries unique and not under the body
+    const uint8_t* cursor = data + payloadOffset;
+    vector<uint8_t> used(area, 0);
+    state.body.resize(frame.bodyLength);
+    for (uint32_t i = 0; i < frame.bodyLength; i++) {
+        PackedCell packed;
+        memcpy(&packed, cursor, sizeof(packed));
+        cursor += sizeof(packed);
+        if (packed.x >= boardSize || packed.y >= boardSize || used[packed.y * boardSize + packed.x]++ != 0) {
+            return false;
+        }
+        state.body[i] = Cell{packed.x, packed.y};
+    }
+    state.freeSpawnCells.resize(frame.freeCellCount);
+    for (uint32_t i = 0; i < frame.freeCellCount; i++) {
+        uint32_t index;
+        memcpy(&index, cursor, sizeof(index));
+        cursor += sizeof(index);
+        if (index >= area || used[index]++ != 0) {
+            return false;
+        }
+        state.freeSpawnCells[i] = (int)index;
+    }
+    return true;
+}
+
+ReplayInputCursor ReplayReader::CursorAt(uint32_t keyframe) const {
+    ReplayKeyframeEntry entry = Keyframe(keyframe);
+    const uint8_t* stream = data + header.inputOffset;
+    return ReplayInputCursor(stream + entry.inputPosition, stream + header.inputSize, entry.deltaBase);
+}
@@ -0,0 +1,186 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstddef>      // size_t for buffer sizes
+#include <cstdint>      // Fixed-width fields of the file format
+#include <string>       // File paths
+#include <vector>       // Buffers of the writer
+
+#include "simulation.h"
+
+// Binary replay of one run, designed to be used straight from a memory
+// mapping (see MappedFile). All fields are little-endian and every section
+// starts on an 8-byte boundary:
+//
+//   ReplayHeader
+//   input stream    one varint per tick whose input is not NONE:
+//                   ((tick - previous event tick) << 3) | input
+//   keyframe index  keyframeCount x ReplayKeyframeEntry, sorted by tick
+//   keyframes       ReplayKeyframeHeader, then bodyLength x PackedCell,
+//                   then freeCellCount x uint32_t (spawn set order)
+//
+// A keyframe holds the complete simulation state before its tick is played,
+// so seeking restores the nearest earlier keyframe and re-simulates at most
+// keyframeInterval - 1 ticks.
+
+const uint16_t replayVersion = 1;
+const uint32_t defaultKeyframeInterval = 256;
+
+struct ReplayHeader {
+    char magic[4]; // "SNKR"
+    uint16_t version; // replayVersion
+    uint16_t boardSize; // Cells along each side of the board
+    uint64_t seed; // Seed the run was restarted with
+    uint8_t difficulty; // SpeedLevel the run was restarted with
+    uint8_t reserved[3];
+    uint32_t keyframeInterval; // Ticks between two keyframes
+    uint32_t tickCount; // Number of recorded steps
+    int32_t finalScore; // Score when the run ended
+    uint32_t keyframeCount; // Entries in the keyframe index
+    uint32_t levelChecksum; // LevelHeader::checksum of the level played, 0 for the built-in board
+    uint64_t inputOffset; // File offset of the input stream
+    uint64_t inputSize; // Size of the input stream in bytes
+    uint64_t keyframeIndexOffset; // File offset of the keyframe index
+};
+static_assert(sizeof(ReplayHeader) == 64, "ReplayHeader layout is part of the file format");
+
+struct ReplayKeyframeEntry {
+    uint32_t tick; // Tick the keyframe was taken before
+    uint32_t inputPosition; // Input stream offset of the first event at or after 'tick'
+    uint32_t deltaBase; // Tick the next event's delta is measured from
+    uint32_t reserved;
+    uint64_t offset; // File offset of the keyframe
+};
+static_assert(sizeof(ReplayKeyframeEntry) == 24, "ReplayKeyframeEntry layout is part of the file format");
+
+// Flag bits of ReplayKeyframeHeader::flags
+enum ReplayKeyframeFlag : uint8_t {
+    KEYFRAME_DIFFICULTY_CHANGED = 1 << 0,
+    KEYFRAME_ADD_SEGMENT        = 1 << 1,
+    KEYFRAME_FOOD_PLACED        = 1 << 2,
+    KEYFRAME_RUNNING            = 1 << 3
+};
+
+struct ReplayKeyframeHeader {
+    uint64_t rngState;
+    int32_t score;
+    int32_t lastScore;
+    int32_t foodEaten;
+    int16_t directionX;
+    int16_t directionY;
+    int16_t foodX;
+    int16_t foodY;
+    uint8_t speedLevel;
+    uint8_t newDifficulty;
+    uint8_t flags; // ReplayKeyframeFlag bits
+    uint8_t reserved;
+    uint32_t bodyLength; // Segments that follow, head first
+    uint32_t freeCellCount; // Spawn set entries that follow the body
+};
+static_assert(sizeof(ReplayKeyframeHeader) == 40, "ReplayKeyframeHeader layout is part of the file format");
+
+// Records a run tick by tick and writes it out as a replay file.
+class ReplayWriter {
+    private:
+        ReplayHeader header; // Header being filled in
+        std::vector<uint8_t> inputs; // Encoded input stream
+        std::vector<ReplayKeyframeEntry> entries; // Keyframe index (offsets relative to 'keyframes')
+        std::vector<uint8_t> keyframes; // Encoded keyframes
+        uint32_t deltaBase = 0; // Tick of the last recorded input event
+
+    public:
+        ReplayWriter() { Begin(0, SpeedLevel::SLOW, cellCount); }
+
+        // Starts recording a run that was restarted with this seed and difficulty.
+        void Begin(uint64_t seed, SpeedLevel level, int boardSize, uint32_t keyframeInterval = defaultKeyframeInterval);
+
+        // Records which level the run is played on (its LevelHeader::checksum, 0 for the built-in board).
+        void SetLevelChecksum(uint32_t checksum) { header.levelChecksum = checksum; }
+
+        // Returns the number of ticks recorded so far.
+        uint32_t TickCount() const { return header.tickCount; }
+
+        // Returns whether a keyframe is due before the next tick.
+        bool WantsKeyframe() const { return header.tickCount % header.keyframeInterval == 0; }
+
+        // Stores the state the next tick starts from.
+        void AddKeyframe(const SimulationState& state);
+
+        // Records the input passed to Step() for the next tick.
+        void AddInput(Input input);
+
+        // Marks the run as finished with its final score.
+        void Finish(int finalScore) { header.finalScore = finalScore; }
+
+        // Writes the replay file, returns false on I/O errors.
+        bool Save(const std::string& path) const;
+};
+
+// Iterates the input stream one tick at a time, in increasing tick order.
+class ReplayInputCursor {
+    private:
+        const uint8_t* position; // Next undecoded byte
+        const uint8_t* end; // End of the input stream
+        uint32_t nextTick; // Tick of the pending event
+        Input nextInput; // Input of the pending event, NONE once the stream is exhausted
+
+        // Decodes the event following 'base'.
+        void Advance(uint32_t base);
+
+    public:
+        ReplayInputCursor(const uint8_t* position, const uint8_t* end, uint32_t deltaBase);
+
+        // Returns the input of 'tick'; ticks must be requested in increasing order.
+        Input InputAt(uint32_t tick);
+};
+
+// Read-only view of a replay held in memory (typically a MappedFile).
+// Open() validates every offset once; the accessors then trust them.
+class ReplayReader {
+    private:
+        const uint8_t* data = nullptr; // Start of the replay bytes
+        size_t size = 0; // Number of bytes
+        ReplayHeader header; // Copy of the validated header
+
+    public:
+        // Checks the header (including a supported board size) and section bounds, and that the
+        // keyframes start at tick 0 in increasing order; returns false for a damaged or foreign file.
+        bool Open(const void* bytes, size_t length);
+
+        // Returns the validated header.
+        const ReplayHeader& Header() const { return header; }
+
+        // Returns a keyframe index entry.
+        ReplayKeyframeEntry Keyframe(uint32_t index) const;
+
+        // Returns the last keyframe taken at or before 'tick'.
+        uint32_t FindKeyframe(uint32_t tick) const;
+
+        // Decodes a keyframe, returns false if its body or spawn set runs past the file or it is not a
+        // state LoadState() can take on this board (cells off the board, overlapping or repeated, bad levels).
+        bool ReadKeyframe(uint32_t index, SimulationState& state) const;
+
+        // Returns a cursor positioned at a keyframe's tick.
+        ReplayInputCursor CursorAt(uint32_t keyframe) const;
+
+        // Method to put 'sim' in the state it had before 'tick' was played
+        template <typename BoardT>
+        bool Seek(BasicSimulation<BoardT>& sim, uint32_t tick) const {
+            if (sim.GetBoard().CellCount() != header.boardSize || tick > header.tickCount) {
+                return false;
+            }
+            uint32_t keyframe = FindKeyframe(tick);
+            SimulationState state;
+            if (!ReadKeyframe(keyframe, state)) {
+                return false;
+            }
+            sim.LoadState(state);
+            ReplayInputCursor cursor = CursorAt(keyframe);
+            for (uint32_t t = Keyframe(keyframe).tick; t < tick; t++) {
+                sim.Step(cursor.InputAt(t));
+            }
+            return true;
+        }
+};
+
+#endif // REPLAY_H
@@ -0,0 +1,179 @@
+#include "sim_thread.h"
+
+#include <chrono>       // Steady clock driving the fixed step
+
+#include "profiler.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// A tick this far behind its deadline gives up on catching up (e.g. after the window was dragged)
+static const int64_t maxLagNanoseconds = 250000000;
+
+// Function to convert a tick period from the speed curves to clock nanoseconds
+static int64_t PeriodNanoseconds(uint32_t periodMicroseconds) {
+    return (int64_t)periodMicroseconds * 1000;
+}
+
+SimulationThread::SimulationThread(uint64_t seed) : sim(seed), events(0), autopilot(false) {
+    unsigned capacity = DefaultBoard::Area() + 1;
+    frames.InitAll([capacity](FrameSnapshot& frame) {
+        frame.body.reserve(capacity); // Publishing never allocates
+        frame.previousBody.reserve(capacity);
+    });
+    int64_t now = ClockNanoseconds();
+    nextTick = now + PeriodNanoseconds(sim.GetTickPeriod());
+    lastBody.reserve(capacity);
+    Publish(now, 0, false);
+    worker = thread(&SimulationThread::Run, this);
+}
+
+SimulationThread::~SimulationThread() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+int64_t SimulationThread::ClockNanoseconds() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double SimulationThread::Now() {
+    return ClockNanoseconds() / 1e9;
+}
+
+void SimulationThread::Start(uint64_t seed, SpeedLevel level) {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        sim.Restart(seed, level);
+        sim.running = false; // The snake waits for the first direction key, which Step() turns into a start
+        solver.Reset();
+        solverDriving = false;
+        replay.Begin(seed, level, cellCount);
+        replay.SetLevelChecksum(levelChecksum);
+        Input stale;
+        while (inputs.TryPop(stale)) {} // Keys pressed in the menu belong to no run
+        paused = false;
+        int64_t now = ClockNanoseconds();
+        nextTick = now + PeriodNanoseconds(sim.GetTickPeriod());
+        lastBody.clear();
+        Publish(now, 0, false);
+    }
+    wake.notify_all();
+}
+
+bool SimulationThread::UseLevel(const Level& level) {
+    lock_guard<std::mutex> lock(mutex);
+    if (!level.Apply(sim)) {
+        return false;
+    }
+    levelChecksum = level.Header().checksum;
+    return true;
+}
+
+void SimulationThread::UseSpeedCurves(const SpeedCurveSet& curves) {
+    lock_guard<std::mutex> lock(mutex);
+    sim.SetSpeedCurves(curves);
+}
+
+bool SimulationThread::SaveReplay(const string& path) {
+    lock_guard<std::mutex> lock(mutex);
+    return replay.Save(path);
+}
+
+void SimulationThread::Run() {
+    Profiler::Get().SetThreadName("simulation");
+    unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (paused) {
+            wake.wait(lock);
+            continue;
+        }
+        // Sleep with the lock released; Start() and shutdown wake the thread early
+        int64_t now = ClockNanoseconds();
+        if (now < nextTick) {
+            wake.wait_for(lock, chrono::nanoseconds(nextTick - now));
+            continue;
+        }
+        Tick(now);
+    }
+}
+
+void SimulationThread::Tick(int64_t now) {
+    PROFILE_SCOPE("sim.Tick");
+    double lateMs = (now - nextTick) / 1e6;
+    int64_t scheduled = nextTick;
+
+    // Record the tick exactly as it is played, so the replay reproduces this run
+    if (replay.WantsKeyframe()) {
+        SimulationState state;
+        sim.SaveState(state);
+        replay.AddKeyframe(state);
+    }
+    Input input = NextTurn(); // Always drained, so no stale turn is left when the autopilot lets go
+    bool driving = autopilot.load(memory_order_relaxed);
+    if (driving && !solverDriving) {
+        solver.Reset(); // The keys moved the snake since the solver's last decision
+    }
+    solverDriving = driving;
+    if (driving) {
+        input = solver.Decide(sim);
+    }
+    replay.AddInput(input);
+    unsigned stepEvents = sim.Step(input);
+    tick++;
+
+    if (stepEvents & EVENT_GAME_OVER) {
+        replay.Finish(sim.lastScore);
+        paused = true; // Wait in the menu until the next Start()
+    }
+    // Deadlines advance by whole integer periods, so ticks drift neither with scheduling jitter nor with rounding
+    nextTick += PeriodNanoseconds(sim.GetTickPeriod());
+    if (now - nextTick > maxLagNanoseconds) {
+        scheduled = now;
+        nextTick = now + PeriodNanoseconds(sim.GetTickPeriod());
+    }
+    Publish(scheduled, lateMs, !(stepEvents & EVENT_GAME_OVER));
+    events.fetch_or(stepEvents, memory_order_release); // After the snapshot, so the renderer sees both
+}
+
+void SimulationThread::Publish(int64_t tickTime, double lateMs, bool continuous) {
+    FrameSnapshot& frame = frames.Back(); // Holds an old frame; every field is overwritten
+    frame.version = published++;
+    frame.tick = tick;
+    frame.tickTime = tickTime / 1e9;
+    frame.interval = (nextTick - tickTime) / 1e9;
+    frame.lateMs = lateMs;
+    frame.previousBody.assign(lastBody.begin(), lastBody.end());
+    lastBody.assign(sim.snake.body.begin(), sim.snake.body.end());
+    frame.body.assign(lastBody.begin(), lastBody.end());
+    frame.continuous = continuous;
+    frame.food = sim.food.position;
+    frame.foodPlaced = sim.food.placed;
+    frame.score = sim.score;
+    frame.lastScore = sim.lastScore;
+    frame.speedLevel = sim.speedLevel;
+    frame.running = sim.running && !paused;
+    frames.Publish();
+}
+
+Input SimulationThread::NextTurn() {
+    // Presses that would not turn the snake (same or opposite direction) would waste a tick;
+    // a stopped snake also starts on its own direction, so only a reversal is dropped then
+    Input input;
+    while (inputs.TryPop(input)) {
+        Cell direction = sim.snake.direction;
+        bool vertical = input == Input::UP || input == Input::DOWN;
+        if ((vertical && direction.y == 0) || (!vertical && direction.x == 0)) {
+            return input;
+        }
+        bool forward = input == Input::UP ? direction.y == -1 : input == Input::DOWN ? direction.y == 1 :
+                       input == Input::LEFT ? direction.x == -1 : direction.x == 1;
+        if (!sim.running && forward) {
+            return input;
+        }
+    }
+    return Input::NONE;
+}
@@ -0,0 +1,112 @@
+#ifndef SIM_THREAD_H
+#define SIM_THREAD_H
+
+#include <atomic>               // Event mask shared with the render thread
+#include <condition_variable>   // Sleeping until the next tick or a restart
+#include <cstdint>              // Seeds and tick counters
+#include <mutex>                // Guards the simulation against restarts and saves
+#include <string>               // Replay paths
+#include <thread>               // The simulation thread
+#include <vector>               // Body copies in the snapshots
+
+#include "level.h"
+#include "replay.h"
+#include "simulation.h"
+#include "solver_policy.h"
+#include "spsc_queue.h"
+#include "triple_buffer.h"
+
+// What the renderer needs from one simulation tick. The body of the tick
+// before is kept alongside, so frames between two ticks can be interpolated.
+struct FrameSnapshot {
+    uint64_t version = 0; // Snapshots published before this one; equal versions hold equal content
+    uint64_t tick = 0; // Ticks played since the thread started
+    double tickTime = 0; // SimulationThread::Now() at which this tick was scheduled
+    double interval = 1; // Seconds until the next tick is due
+    double lateMs = 0; // How far behind its deadline this tick ran
+    std::vector<Cell> body; // Snake after the tick, head first
+    std::vector<Cell> previousBody; // Snake before the tick, head first
+    bool continuous = false; // False when previousBody belongs to another run (no interpolation)
+    Cell food = {0, 0}; // Food position
+    bool foodPlaced = false; // False while the board has no room for food
+    int score = 0; // Score of the current run
+    int lastScore = 0; // Score of the most recently finished run
+    SpeedLevel speedLevel = SpeedLevel::SLOW; // Speed level of the current run
+    bool running = false; // True while ticks are being played
+};
+
+// Runs the game simulation on its own thread at a fixed step, independent of
+// the frame rate. The render thread pushes turns into a lock-free queue (one
+// is applied per tick, so quick double turns are never lost) and reads the
+// newest FrameSnapshot from a triple buffer without ever blocking the ticks.
+// After a game over the thread pauses until Start() begins the next run.
+class SimulationThread {
+    private:
+        Simulation sim; // Game state, only touched with 'mutex' held
+        ReplayWriter replay; // Recording of the current run, guarded by 'mutex'
+        SpscQueue<Input, 64> inputs; // Turns waiting for a tick
+        TripleBuffer<FrameSnapshot> frames; // Latest state for the renderer
+        std::atomic<unsigned> events; // StepEvent flags not yet taken by the renderer
+        std::atomic<bool> autopilot; // The solver steers instead of the queued turns
+        SolverPolicy<DefaultBoard> solver; // Built-in player used while 'autopilot' is set
+        bool solverDriving = false; // The solver decided the last tick; reset it when it takes over again
+        std::mutex mutex; // Guards sim, replay and the fields below
+        std::condition_variable wake; // Signalled on Start() and on shutdown
+        bool paused = true; // No ticks are played while set
+        bool stopping = false; // Set when the thread must exit
+        int64_t nextTick = 0; // ClockNanoseconds() at which the next tick is due
+        uint64_t tick = 0; // Ticks played so far
+        uint64_t published = 0; // Snapshots published so far
+        uint32_t levelChecksum = 0; // Level the runs are played on, recorded in every replay
+        std::vector<Cell> lastBody; // Body of the previously published snapshot
+        std::thread worker; // Runs Run(), declared last so everything above exists first
+
+        // Thread body: sleeps until each deadline and plays one tick.
+        void Run();
+        // Plays one tick and publishes its snapshot; 'mutex' is held.
+        void Tick(int64_t now);
+        // Copies the simulation into the writer's snapshot and publishes it; 'mutex' is held.
+        void Publish(int64_t tickTime, double lateMs, bool continuous);
+        // Returns the next queued turn that would change the snake's direction or start it moving.
+        Input NextTurn();
+
+    public:
+        explicit SimulationThread(uint64_t seed);
+        ~SimulationThread();
+
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        // Nanoseconds on the steady clock; the thread schedules ticks on this integer count.
+        static int64_t ClockNanoseconds();
+
+        // Seconds on the same clock, for the renderer's interpolation.
+        static double Now();
+
+        // Plays the following runs on 'level' (its walls are copied), returns false if its board is not the default one.
+        bool UseLevel(const Level& level);
+
+        // Times the ticks with other speed curves (kept by pointer, so they must outlive the thread).
+        void UseSpeedCurves(const SpeedCurveSet& curves);
+
+        // Starts a new, recorded run and resumes ticking; the snake stays still until the first direction key.
+        void Start(uint64_t seed, SpeedLevel level);
+
+        // Render thread: queues a turn for a coming tick, returns false if the queue is full.
+        bool PushInput(Input input) { return inputs.TryPush(input); }
+
+        // Render thread: hands the snake to the solver (true) or back to the queued turns (false).
+        void SetAutopilot(bool enabled) { autopilot.store(enabled, std::memory_order_relaxed); }
+        bool IsAutopilot() const { return autopilot.load(std::memory_order_relaxed); }
+
+        // Render thread: returns the StepEvent flags raised since the last call.
+        unsigned TakeEvents() { return events.exchange(0, std::memory_order_acquire); }
+
+        // Render thread: returns the newest snapshot.
+        const FrameSnapshot& LatestFrame() { return frames.Read(); }
+
+        // Writes the replay of the last finished run, returns false on I/O errors.
+        bool SaveReplay(const std::string& path);
+};
+
+#endif // SIM_THREAD_H
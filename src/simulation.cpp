@@ -0,0 +1,47 @@
+#include "simulation.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Function to convert SpeedLevel enum to a string for display
+string SpeedLevelToString(SpeedLevel level) {
+    switch(level) {
+        case SpeedLevel::SLOW: return "Slow";
+        case SpeedLevel::MEDIUM: return "Medium";
+        case SpeedLevel::FAST: return "Fast";
+        case SpeedLevel::VERY_FAST: return "Very Fast";
+        default: return "Unknown";
+    }
+}
+
+uint64_t Rng::Next() {
+    // splitmix64: one add and three xor-shift-multiply rounds per value
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+int Rng::GetRandomValue(int min, int max) {
+    if (min > max) {
+        swap(min, max); // Same forgiving behaviour as raylib
+    }
+    uint64_t range = (uint64_t)((int64_t)max - min) + 1;
+    // Multiply-shift maps 32 random bits onto the range without a division
+    return min + (int)(((Next() >> 32) * range) >> 32);
+}
+
+int FoodMinDistance(SpeedLevel difficulty) {
+    switch (difficulty) {
+        case SpeedLevel::SLOW:       return 4;
+        case SpeedLevel::MEDIUM:     return 3;
+        case SpeedLevel::FAST:       return 2;
+        case SpeedLevel::VERY_FAST:  return 1;
+        default:                     return 1;
+    }
+}
+
+// Compile the board specializations once for every translation unit
+template class BasicSimulation<Board<29>>;
+template class BasicSimulation<Board<64>>;
+template class BasicSimulation<Board<256>>;
+template class BasicSimulation<DynamicBoard>;
@@ -0,0 +1,458 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <cstdint>      // Fixed-width integer types for the random number generator state
+#include <string>       // The string class used for display names
+#include <vector>       // The vector containers of SimulationState
+
+#include "board.h"
+#include "cell.h"
+#include "occupancy_grid.h"
+#include "snake_body.h"
+#include "speed_curve.h"
+
+// Headless game core: everything in this file is free of raylib calls so the
+// simulation can run on machines without a display or an audio device.
+// The snake, the food and the simulation are templated on the board type
+// (see board.h); Simulation is the classic 29x29 game.
+
+// Enumeration for different speed levels in the game
+enum class SpeedLevel {
+    SLOW,
+    MEDIUM,
+    FAST,
+    VERY_FAST
+};
+
+// Function to convert SpeedLevel enum to a string for display
+std::string SpeedLevelToString(SpeedLevel level);
+
+// Direction requested by the player for the next simulation step
+enum class Input {
+    NONE,
+    UP,
+    DOWN,
+    LEFT,
+    RIGHT
+};
+
+// Bit flags describing what happened during a single simulation step
+enum StepEvent : unsigned {
+    EVENT_NONE      = 0,
+    EVENT_ATE_FOOD  = 1 << 0, // The snake ate the food this step
+    EVENT_HIT_WALL  = 1 << 1, // The snake left the board
+    EVENT_HIT_TAIL  = 1 << 2, // The snake ran into its own body
+    EVENT_GAME_OVER = 1 << 3, // The run ended and the board was reset
+    EVENT_BOARD_FULL = 1 << 4, // No free cell was left to spawn the food on
+    EVENT_HIT_OBSTACLE = 1 << 5 // The snake ran into a wall of the level
+};
+
+// Small seeded pseudo-random generator (splitmix64), replaces raylib's GetRandomValue
+class Rng {
+    private:
+        uint64_t state; // Current generator state, fully determined by the seed
+
+    public:
+        explicit Rng(uint64_t seed = 0) : state(seed) {}
+
+        // Restarts the sequence from a new seed.
+        void Seed(uint64_t seed) { state = seed; }
+
+        // Returns the raw generator state (useful to save and restore a run).
+        uint64_t GetState() const { return state; }
+
+        // Returns the next 64 random bits.
+        uint64_t Next();
+
+        // Returns a random value between min and max (both included), like GetRandomValue.
+        int GetRandomValue(int min, int max);
+};
+
+// Number of cells along each side of the default board
+const int cellCount = DefaultBoard::CellCount();
+
+// Function to get how far from the edges food must spawn at a difficulty
+int FoodMinDistance(SpeedLevel difficulty);
+
+// Where a run starts and where food may spawn; the classic game's rules unless a level sets others.
+struct LevelRules {
+    Cell start = {6, 9}; // Head of the starting snake
+    Cell direction = {1, 0}; // Starting direction, the body is laid out behind the head
+    int startLength = 3; // Segments of the starting snake
+    int foodMargin[4] = {FoodMinDistance(SpeedLevel::SLOW), FoodMinDistance(SpeedLevel::MEDIUM),
+                         FoodMinDistance(SpeedLevel::FAST), FoodMinDistance(SpeedLevel::VERY_FAST)}; // Spawn margin per SpeedLevel
+};
+
+template <typename BoardT>
+class Snake {
+    public:
+        // A ring buffer representing the snake's body, each segment as a packed cell (x, y position).
+        SnakeBody body;
+        // The direction the snake is moving in, initially set to move right (1, 0).
+        Cell direction = {1, 0};
+        // A flag to indicate whether a new segment should be added to the snake's body.
+        bool addSegment = false;
+        // Set when the last update would have moved the head off the board.
+        bool leftBoard = false;
+        // Per-cell segment counts, kept in step with the body on every push and pop.
+        OccupancyGrid<BoardT> occupancy;
+        // Where Reset() puts the snake.
+        Cell start = {6, 9};
+        Cell startDirection = {1, 0};
+        int startLength = 3;
+
+        // The body can hold every cell of the board plus the head pushed before the tail pops.
+        explicit Snake(BoardT board) : body(board.Area() + 1), occupancy(board) {
+            Reset();
+        }
+
+        // Returns whether the head shares its cell with another segment.
+        bool HeadHitsBody() const {
+            return occupancy.Count(body[0]) > 1;
+        }
+
+        // Method to update the snake's state, including its position and size.
+        void Update() {
+            Cell head = Cell{body[0].x + direction.x, body[0].y + direction.y};
+            if (!occupancy.Contains(head)) {
+                // Off-board cells cannot be packed; the body stays put and the edge check ends the run
+                leftBoard = true;
+                return;
+            }
+            // Adds a new segment to the front of the snake in its current direction.
+            body.push_front(head);
+            occupancy.Occupy(head);
+            // Checks if a new segment should be added.
+            if(addSegment) {
+                addSegment = false; // Resets the flag if a segment was added.
+            } else {
+                occupancy.Vacate(body.back());
+                body.pop_back(); // Removes the last segment of the body if not growing.
+            }
+        }
+
+        // Method to reset the snake to its initial state.
+        void Reset() {
+            // Reinitializes the snake's body to its starting size and position.
+            body.clear();
+            occupancy.Clear();
+            for (int i = 0; i < startLength; i++) {
+                Cell cell = Cell{start.x - startDirection.x * i, start.y - startDirection.y * i};
+                body.push_back(cell);
+                occupancy.Occupy(cell);
+            }
+            // Resets the direction of the snake to its starting one.
+            direction = startDirection;
+            addSegment = false;
+            leftBoard = false;
+        }
+};
+
+template <typename BoardT>
+class Food {
+    private:
+        SpeedLevel currentDifficulty; // Difficulty used to keep food away from the edges
+        Rng* rng; // Generator shared with the owning simulation
+        int margins[4]; // Spawn margin per SpeedLevel
+
+    public:
+        Cell position = {0, 0}; // Stores the position of the food
+        bool placed = false; // False while no free cell was left inside the spawn margin
+
+        Food(SpeedLevel difficulty, Rng& rng) : currentDifficulty(difficulty), rng(&rng) {
+            SetMargins(LevelRules().foodMargin);
+        }
+
+        // Changes the difficulty used for the following spawns.
+        void SetDifficulty(SpeedLevel difficulty) { currentDifficulty = difficulty; }
+
+        // Replaces the spawn margin of every SpeedLevel.
+        void SetMargins(const int (&levelMargins)[4]) {
+            for (int i = 0; i < 4; i++) {
+                margins[i] = levelMargins[i];
+            }
+        }
+
+        // Method to get how far from the edges food must spawn at the current difficulty
+        int GetMinDistance() const { return margins[(int)currentDifficulty]; }
+
+        // Method to pick a random free cell inside the margin, returns false when there is none
+        bool GenerateRandomPos(const Snake<BoardT>& snake, Cell& position) {
+            // The grid keeps every empty cell of the spawn area in a dense set, so one
+            // random pick is enough and an exhausted area is detected immediately
+            const FreeCellSet& freeCells = snake.occupancy.FreeSpawnCells();
+            if (freeCells.Empty()) {
+                return false;
+            }
+            int slot = rng->GetRandomValue(0, freeCells.Size() - 1);
+            position = snake.occupancy.CellAt(freeCells.At(slot));
+            return true;
+        }
+
+        // Method to move the food to a new free cell, updating 'placed'
+        bool Respawn(const Snake<BoardT>& snake) {
+            placed = GenerateRandomPos(snake, position);
+            return placed;
+        }
+};
+
+// Complete copy of a simulation between two steps, used for replay keyframes.
+// Restoring it and replaying the same inputs reproduces the original run.
+struct SimulationState {
+    uint64_t rngState; // Generator state
+    SpeedLevel speedLevel; // Current difficulty
+    bool difficultyHasChanged; // Pending ChangeDifficulty() request
+    SpeedLevel newDifficulty; // Difficulty of the pending request
+    std::vector<Cell> body; // Segments from head to tail
+    Cell direction; // Snake direction
+    bool addSegment; // Snake grows on the next step
+    Cell foodPosition; // Food cell
+    bool foodPlaced; // Food is on the board
+    bool running; // Game is running
+    int score; // Current score
+    int lastScore; // Score of the last finished run
+    int foodEaten; // Food eaten since the last restart
+    std::vector<int> freeSpawnCells; // Spawn set in its internal order (spawns pick by position)
+};
+
+// Deterministic fixed-step game simulation. Each call to Step() advances the
+// game by exactly one tick; the caller decides how ticks map to real time.
+template <typename BoardT>
+class BasicSimulation {
+    private:
+        Rng rng; // Seeded generator, must be declared before food
+        bool difficultyHasChanged; // Flag to track if the game's difficulty level has changed.
+        SpeedLevel newDifficulty; // Stores the new difficulty level when a change is requested.
+        const SpeedCurveSet* speedCurves = &DefaultSpeedCurves(); // Tick period tables of the speed levels
+        uint32_t tickPeriod = 0; // Microseconds per tick at the current level and score
+
+        // Looks the tick period up again; called whenever the level or the score changes.
+        void RefreshTickPeriod() { tickPeriod = speedCurves->Level((int)speedLevel).PeriodAt(score); }
+
+    public:
+        Snake<BoardT> snake; // The player-controlled snake.
+        Food<BoardT> food;   // The food in the game.
+        bool running = true; // Flag indicating whether the game is currently running.
+        int score = 0; // Variable to keep track of the player's score.
+        int lastScore = 0; // Score of the most recently finished run.
+        int foodEaten = 0; // Total number of food items eaten since the last restart.
+        SpeedLevel speedLevel; // The current speed level of the game.
+
+        explicit BasicSimulation(uint64_t seed, SpeedLevel level = SpeedLevel::SLOW, BoardT board = BoardT())
+            : rng(seed), difficultyHasChanged(false), newDifficulty(level), snake(board), food(level, rng), speedLevel(level) {
+            Restart(seed, level);
+        }
+
+        // Food keeps a pointer to this object's generator, so simulations are not copied; use SaveState().
+        BasicSimulation(const BasicSimulation&) = delete;
+        BasicSimulation& operator=(const BasicSimulation&) = delete;
+
+        // Method to start a new run from a seed, exactly as a freshly constructed simulation would
+        void Restart(uint64_t seed, SpeedLevel level) {
+            rng.Seed(seed);
+            difficultyHasChanged = false;
+            newDifficulty = level;
+            speedLevel = level;
+            food.SetDifficulty(level);
+            snake.Reset();
+            snake.occupancy.SetSpawnMargin(food.GetMinDistance());
+            food.Respawn(snake);
+            running = true;
+            score = 0;
+            lastScore = 0;
+            foodEaten = 0;
+            RefreshTickPeriod();
+        }
+
+        // Method to play on a level: its start and spawn rules and its walls (a row-major bitmap, null for none).
+        // The snake goes back to the level's start; states saved on another level cannot be loaded afterwards.
+        void SetLevel(const LevelRules& rules, const uint8_t* wallBits) {
+            snake.start = rules.start;
+            snake.startDirection = rules.direction;
+            snake.startLength = rules.startLength;
+            snake.occupancy.SetWalls(wallBits);
+            food.SetMargins(rules.foodMargin);
+            snake.Reset();
+            snake.occupancy.SetSpawnMargin(food.GetMinDistance());
+            food.Respawn(snake);
+        }
+
+        // Method to copy the complete state between two steps
+        void SaveState(SimulationState& state) const {
+            state.rngState = rng.GetState();
+            state.speedLevel = speedLevel;
+            state.difficultyHasChanged = difficultyHasChanged;
+            state.newDifficulty = newDifficulty;
+            state.body.assign(snake.body.begin(), snake.body.end());
+            state.direction = snake.direction;
+            state.addSegment = snake.addSegment;
+            state.foodPosition = food.position;
+            state.foodPlaced = food.placed;
+            state.running = running;
+            state.score = score;
+            state.lastScore = lastScore;
+            state.foodEaten = foodEaten;
+            const FreeCellSet& freeCells = snake.occupancy.FreeSpawnCells();
+            state.freeSpawnCells.resize(freeCells.Size());
+            for (int i = 0; i < freeCells.Size(); i++) {
+                state.freeSpawnCells[i] = freeCells.At(i);
+            }
+        }
+
+        // Method to restore a state saved on a simulation with the same board
+        void LoadState(const SimulationState& state) {
+            rng.Seed(state.rngState);
+            speedLevel = state.speedLevel;
+            difficultyHasChanged = state.difficultyHasChanged;
+            newDifficulty = state.newDifficulty;
+            food.SetDifficulty(state.speedLevel);
+            snake.occupancy.SetSpawnMargin(food.GetMinDistance());
+            snake.body.clear();
+            snake.occupancy.Clear();
+            for (const Cell& cell : state.body) {
+                snake.body.push_back(cell);
+                snake.occupancy.Occupy(cell);
+            }
+            snake.occupancy.RestoreFreeSpawnCells(state.freeSpawnCells.data(), (int)state.freeSpawnCells.size());
+            snake.direction = state.direction;
+            snake.addSegment = state.addSegment;
+            snake.leftBoard = false;
+            food.position = state.foodPosition;
+            food.placed = state.foodPlaced;
+            running = state.running;
+            score = state.score;
+            lastScore = state.lastScore;
+            foodEaten = state.foodEaten;
+            RefreshTickPeriod();
+        }
+
+        // Returns the board geometry.
+        const BoardT& GetBoard() const { return snake.occupancy.GetBoard(); }
+
+        // Method to use other speed curves (kept by pointer, so they must outlive the simulation)
+        void SetSpeedCurves(const SpeedCurveSet& curves) {
+            speedCurves = &curves;
+            RefreshTickPeriod();
+        }
+
+        // Returns how long the next tick lasts, in microseconds, from the speed curve of the level
+        uint32_t GetTickPeriod() const { return tickPeriod; }
+
+        // Returns how long the next tick lasts, in seconds
+        double GetUpdateInterval() const { return tickPeriod / 1e6; }
+
+        // Method to request a change in game difficulty, applied at the end of the next step
+        void ChangeDifficulty(SpeedLevel newLevel) {
+            newDifficulty = newLevel;
+            difficultyHasChanged = true;
+        }
+
+        // Method to update the game's difficulty immediately
+        void SetDifficulty(SpeedLevel newLevel) {
+            speedLevel = newLevel;
+            food.SetDifficulty(newLevel);
+            snake.occupancy.SetSpawnMargin(food.GetMinDistance());
+            food.Respawn(snake); // Respawn the food inside the new margin.
+            RefreshTickPeriod();
+        }
+
+        // Method to turn the snake, ignoring reversals; a valid turn (re)starts the game
+        void Steer(Input input) {
+            // Each branch refuses to turn the snake straight back into its own neck
+            if (input == Input::UP && snake.direction.y != 1) {
+                snake.direction = {0, -1};
+                running = true;
+            } else if (input == Input::DOWN && snake.direction.y != -1) {
+                snake.direction = {0, 1};
+                running = true;
+            } else if (input == Input::LEFT && snake.direction.x != 1) {
+                snake.direction = {-1, 0};
+                running = true;
+            } else if (input == Input::RIGHT && snake.direction.x != -1) {
+                snake.direction = {1, 0};
+                running = true;
+            }
+        }
+
+        // Method to advance the game by one tick, returns a mask of StepEvent flags
+        unsigned Step(Input input = Input::NONE) {
+            Steer(input);
+            unsigned events = EVENT_NONE;
+            if (running) {
+                snake.Update(); // Update the snake's position and size.
+                events |= CheckCollisionWithFood(); // Check for collisions with food.
+                events |= CheckCollisionWithEdges(); // Check for collisions with the edges of the game area.
+                if (running) {
+                    events |= CheckCollisionWithTail(); // Check for collisions with the snake's own tail.
+                }
+                // Retry a spawn that found the margin full; the tail may have freed a cell
+                if (running && !food.placed && !food.Respawn(snake)) {
+                    events |= EVENT_BOARD_FULL;
+                }
+
+                // If the difficulty has changed, update it and reset the flag.
+                if (difficultyHasChanged) {
+                    SetDifficulty(newDifficulty);
+                    difficultyHasChanged = false;
+                }
+            }
+            return events;
+        }
+
+    private:
+        unsigned CheckCollisionWithFood() {
+            if(food.placed && snake.body[0] == food.position) {
+                // If the snake's head is at the same position as the food
+                snake.addSegment = true; // Grow the snake.
+                score += scoreQuantum; // Increase the score.
+                foodEaten++;
+                RefreshTickPeriod();
+                if (!food.Respawn(snake)) { // Move the food to a new position.
+                    return EVENT_ATE_FOOD | EVENT_BOARD_FULL;
+                }
+                return EVENT_ATE_FOOD;
+            }
+            return EVENT_NONE;
+        }
+
+        unsigned CheckCollisionWithEdges() {
+            // Check if the snake's head tried to move beyond the game area boundaries
+            if(snake.leftBoard) {
+                GameOver(); // End the game if there is a collision.
+                return EVENT_HIT_WALL | EVENT_GAME_OVER;
+            }
+            return EVENT_NONE;
+        }
+
+        unsigned CheckCollisionWithTail() {
+            // The occupancy grid counts two segments on the head's cell after a bite, or on a wall
+            if(snake.HeadHitsBody()) {
+                unsigned hit = snake.occupancy.IsWall(snake.body[0]) ? EVENT_HIT_OBSTACLE : EVENT_HIT_TAIL;
+                GameOver(); // End the game if the snake collides with its tail or a wall.
+                return hit | EVENT_GAME_OVER;
+            }
+            return EVENT_NONE;
+        }
+
+        void GameOver() {
+            lastScore = score; // Keep the final score for the front end's leaderboard.
+            snake.Reset(); // Reset the snake to its initial state.
+            food.Respawn(snake); // Move the food to a new position.
+            running = false; // Stop the game.
+            score = 0; // Reset the score.
+            RefreshTickPeriod();
+        }
+};
+
+// The classic 29x29 game used by the windowed front end.
+typedef BasicSimulation<DefaultBoard> Simulation;
+
+// These four specializations are compiled once, in simulation.cpp, and every other
+// translation unit links to them. Any other board type is instantiated implicitly
+// in each translation unit that uses it.
+extern template class BasicSimulation<Board<29>>;
+extern template class BasicSimulation<Board<64>>;
+extern template class BasicSimulation<Board<256>>;
+extern template class BasicSimulation<DynamicBoard>;
+
+#endif // SIMULATION_H
@@ -0,0 +1,118 @@
+#ifndef SNAKE_BODY_H
+#define SNAKE_BODY_H
+
+#include <cstddef>      // std::ptrdiff_t for the iterator traits
+#include <cstdint>      // Fixed-width integer types for the packed coordinates
+#include <iterator>     // Iterator category tag
+#include <vector>       // The vector container backing the ring
+
+#include "cell.h"
+
+// One body segment stored as two 16-bit coordinates (4 bytes per segment)
+struct PackedCell {
+    uint16_t x;
+    uint16_t y;
+};
+
+// Fixed-capacity ring buffer of packed segments, front = head, back = tail.
+// The storage is allocated once for the largest possible snake, so growing
+// and moving never allocate. Segments occupy at most two contiguous runs of
+// the storage (see ForEachSpan), which keeps bulk passes vectorizable.
+class SnakeBody {
+    private:
+        std::vector<PackedCell> ring; // Power-of-two sized storage
+        unsigned mask; // ring.size() - 1, turns wrap-around into a bit mask
+        unsigned head = 0; // Storage slot of the front segment
+        unsigned length = 0; // Number of segments
+
+        // Returns the smallest power of two that is at least 'value'.
+        static unsigned RoundUpToPowerOfTwo(unsigned value) {
+            unsigned result = 1;
+            while (result < value) {
+                result <<= 1;
+            }
+            return result;
+        }
+
+    public:
+        // Read-only iterator yielding unpacked cells from head to tail.
+        class const_iterator {
+            private:
+                const SnakeBody* body;
+                unsigned index;
+
+            public:
+                typedef std::input_iterator_tag iterator_category;
+                typedef Cell value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const Cell* pointer;
+                typedef Cell reference;
+
+                const_iterator(const SnakeBody* body, unsigned index) : body(body), index(index) {}
+                Cell operator*() const { return (*body)[index]; }
+                const_iterator& operator++() { ++index; return *this; }
+                bool operator==(const const_iterator& other) const { return index == other.index; }
+                bool operator!=(const const_iterator& other) const { return index != other.index; }
+        };
+
+        // Creates an empty body able to hold 'capacity' segments (the board area plus the new head).
+        explicit SnakeBody(unsigned capacity)
+            : ring(RoundUpToPowerOfTwo(capacity)), mask(RoundUpToPowerOfTwo(capacity) - 1) {}
+
+        // Returns the number of segments.
+        unsigned size() const { return length; }
+
+        // Returns the number of segments the storage can hold.
+        unsigned capacity() const { return mask + 1; }
+
+        // Returns the segment at position i, counted from the head.
+        Cell operator[](unsigned i) const {
+            const PackedCell& packed = ring[(head + i) & mask];
+            return Cell{packed.x, packed.y};
+        }
+
+        // Returns the head segment.
+        Cell front() const { return (*this)[0]; }
+
+        // Returns the tail segment.
+        Cell back() const { return (*this)[length - 1]; }
+
+        // Adds a new head; the cell must lie on the board.
+        void push_front(Cell cell) {
+            head = (head - 1) & mask;
+            ring[head] = PackedCell{(uint16_t)cell.x, (uint16_t)cell.y};
+            length++;
+        }
+
+        // Adds a new tail; the cell must lie on the board.
+        void push_back(Cell cell) {
+            ring[(head + length) & mask] = PackedCell{(uint16_t)cell.x, (uint16_t)cell.y};
+            length++;
+        }
+
+        // Removes the tail segment.
+        void pop_back() { length--; }
+
+        // Removes every segment.
+        void clear() {
+            head = 0;
+            length = 0;
+        }
+
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, length); }
+
+        // Calls visit(data, count) for each contiguous run of segments, head first.
+        template <typename Visitor>
+        void ForEachSpan(Visitor&& visit) const {
+            unsigned firstRun = capacity() - head;
+            if (length <= firstRun) {
+                visit(&ring[head], length);
+            } else {
+                visit(&ring[head], firstRun);
+                visit(&ring[0], length - firstRun);
+            }
+        }
+};
+
+#endif // SNAKE_BODY_H
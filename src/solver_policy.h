@@ -0,0 +1,291 @@
+#ifndef SOLVER_POLICY_H
+#define SOLVER_POLICY_H
+
+#include <cstdint>      // Fixed-width integer type for the visit stamps
+#include <vector>       // The vector containers of the reusable buffers
+
+#include "simulation.h"
+
+// Built-in player that never loses on boards with a Hamiltonian cycle.
+//
+// A closed path through the board (the cycle) is computed once. While the
+// snake's segments lie on it in cycle order, tail to head, following the
+// cycle can never trap the snake; shortcuts toward the food are taken only
+// if they land strictly between the head and the tail, which keeps that
+// order. A decision is then three table lookups per neighbour.
+//
+// When the body is not in cycle order (a board without a cycle through the
+// start position, or a game handed over mid-run) the solver falls back to a
+// breadth-first search to the food, taken only if a virtual snake that
+// followed the path could still reach its own tail; otherwise it chases its
+// tail. The search reuses stamped buffers, so no decision allocates. As soon
+// as the body happens to lie in cycle order again, cycle mode takes over.
+// Cycle mode trusts the previous decision, so Reset() must be called whenever
+// the solver did not drive the last step (a new run, or manual play before
+// the solver takes over).
+// On a level with walls the cycle is not used; the search treats walls like
+// the body.
+template <typename BoardT>
+class SolverPolicy {
+    private:
+        BoardT board; // Geometry of the board
+        int area; // Number of cells
+        int cycleLength = 0; // Cells on the cycle (area, or area - 1 on odd boards)
+        std::vector<int> cyclePosition; // Position of each cell on the cycle, -1 for the cell left out
+        std::vector<int> cycleCells; // Cell index at each cycle position
+        bool cycleMode = false; // The body was in cycle order after the last decision
+        int expectedHead = -1; // Cell the last cycle-mode decision moved to
+        unsigned expectedLength = 0; // Body length when that decision was made
+
+        // Reusable search buffers, indexed by cell
+        std::vector<uint32_t> seen; // Stamp of the search that last reached the cell
+        std::vector<uint32_t> blocked; // Stamp of the virtual body that last covered the cell
+        std::vector<int> parent; // Cell the search reached this one from
+        std::vector<int> queue; // Breadth-first frontier
+        std::vector<int> path; // Scratch: food path, head end last
+        uint32_t stamp = 0; // Current search stamp
+        const OccupancyGrid<BoardT>* grid = nullptr; // Grid of the simulation being decided for (walls)
+
+        // Returns the forward distance from cycle position a to b.
+        int CycleDistance(int a, int b) const {
+            int distance = b - a;
+            return distance < 0 ? distance + cycleLength : distance;
+        }
+
+        // Appends 'cell' to the cycle.
+        void AddToCycle(int x, int y) {
+            int index = board.Index(Cell{x, y});
+            cyclePosition[index] = (int)cycleCells.size();
+            cycleCells.push_back(index);
+        }
+
+        // Builds the cycle: boustrophedon rows over every column but the last, which is the way back up.
+        // An odd board cannot have a cycle through all its cells, so the bottom two rows are
+        // zigzagged column by column instead and the bottom-right corner is left out.
+        // The starting body (row 9, heading right) lies on it in order on boards from 12 cells up.
+        void BuildCycle() {
+            const int n = board.CellCount();
+            const int zigzagRows = n % 2 == 0 ? n : n - 2;
+            for (int y = 0; y < zigzagRows; y++) {
+                for (int i = 0; i < n - 1; i++) {
+                    AddToCycle(y % 2 == 0 ? n - 2 - i : i, y);
+                }
+            }
+            if (n % 2 != 0) {
+                for (int x = 0; x < n - 1; x++) {
+                    AddToCycle(x, x % 2 == 0 ? n - 2 : n - 1);
+                    AddToCycle(x, x % 2 == 0 ? n - 1 : n - 2);
+                }
+            }
+            for (int y = n % 2 == 0 ? n - 1 : n - 2; y >= 0; y--) {
+                AddToCycle(n - 1, y);
+            }
+            cycleLength = (int)cycleCells.size();
+        }
+
+        // Returns whether the body lies on the cycle in order, tail to head.
+        bool BodyInCycleOrder(const Snake<BoardT>& snake) const {
+            int span = 0;
+            for (unsigned i = 0; i + 1 < snake.body.size(); i++) {
+                int ahead = cyclePosition[board.Index(snake.body[i])];
+                int behind = cyclePosition[board.Index(snake.body[i + 1])];
+                if (ahead < 0 || behind < 0 || ahead == behind) {
+                    return false;
+                }
+                span += CycleDistance(behind, ahead);
+            }
+            return cyclePosition[board.Index(snake.body[0])] >= 0 && span < cycleLength;
+        }
+
+        // Cycle mode: follows the cycle, shortcutting toward the food where the order stays intact.
+        int DecideOnCycle(const BasicSimulation<BoardT>& sim) const {
+            const Snake<BoardT>& snake = sim.snake;
+            int headPosition = cyclePosition[board.Index(snake.body[0])];
+            int toTail = CycleDistance(headPosition, cyclePosition[board.Index(snake.body.back())]);
+            int toFood = sim.food.placed ? CycleDistance(headPosition, cyclePosition[board.Index(sim.food.position)]) : 1;
+            // Cells the shortcuts skipped between the tail and the head; they only free up once the tail passes
+            int holes = cycleLength - toTail - ((int)snake.body.size() - 1);
+            // Segments still to grow shrink the free stretch ahead before the tail moves again
+            int reserve = 2 + (snake.addSegment ? 1 : 0);
+            int best = cycleCells[(headPosition + 1) % cycleLength];
+            int bestJump = 1;
+            // Past half the cycle, holes would outlive the free stretch ahead: only follow the cycle
+            if (2 * (int)snake.body.size() >= cycleLength) {
+                return best;
+            }
+            Cell head = snake.body[0];
+            const Cell deltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+            for (const Cell& delta : deltas) {
+                Cell next = Cell{head.x + delta.x, head.y + delta.y};
+                if (!board.Contains(next) || cyclePosition[board.Index(next)] < 0) {
+                    continue;
+                }
+                int jump = CycleDistance(headPosition, cyclePosition[board.Index(next)]);
+                // Never jump past the food, and leave room between the new head and the tail
+                if (jump > bestJump && jump <= toFood && toTail - jump > reserve + holes + jump - 1) {
+                    best = board.Index(next);
+                    bestJump = jump;
+                }
+            }
+            return best;
+        }
+
+        // Returns whether a cell is free for the search: on the board, not a wall and not covered by the
+        // current stamp's virtual body.
+        bool Open(Cell cell) const {
+            return board.Contains(cell) && blocked[board.Index(cell)] != stamp && !grid->IsWall(cell);
+        }
+
+        // Breadth-first search from 'from' to 'to' over open cells; fills 'parent' and returns whether 'to' was reached.
+        bool Search(int from, int to) {
+            const Cell deltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+            int front = 0, back = 0;
+            queue[back++] = from;
+            seen[from] = stamp;
+            while (front < back) {
+                int index = queue[front++];
+                if (index == to) {
+                    return true;
+                }
+                Cell cell = board.CellAt(index);
+                for (const Cell& delta : deltas) {
+                    Cell next = Cell{cell.x + delta.x, cell.y + delta.y};
+                    if (!Open(next)) {
+                        continue;
+                    }
+                    int nextIndex = board.Index(next);
+                    if (seen[nextIndex] != stamp) {
+                        seen[nextIndex] = stamp;
+                        parent[nextIndex] = index;
+                        queue[back++] = nextIndex;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Starts a new search stamp and blocks every segment but the tail (which moves away in time).
+        void BlockBody(const Snake<BoardT>& snake) {
+            stamp++;
+            for (unsigned i = 0; i + 1 < snake.body.size(); i++) {
+                blocked[board.Index(snake.body[i])] = stamp;
+            }
+        }
+
+        // Returns whether a snake that followed 'path' (head end last) to the food could still reach its tail.
+        bool PathKeepsTailReachable(const Snake<BoardT>& snake) {
+            // The virtual body is the path (newest first) followed by the front of the current body,
+            // one segment longer than now because the food is eaten at the end of the path
+            unsigned length = snake.body.size() + 1 + (snake.addSegment ? 1 : 0);
+            stamp++;
+            int tail = -1;
+            unsigned placed = 0;
+            for (size_t i = 0; i < path.size() && placed < length; i++, placed++) {
+                tail = path[i];
+                blocked[tail] = stamp;
+            }
+            for (unsigned i = 0; placed < length && i < snake.body.size(); i++, placed++) {
+                tail = board.Index(snake.body[i]);
+                blocked[tail] = stamp;
+            }
+            blocked[tail] = 0; // The tail moves on, so the head may follow it there
+            return Search(path[0], tail);
+        }
+
+        // Search mode: BFS to the food with the virtual-snake check, otherwise the longest safe way to the tail.
+        int DecideBySearch(const BasicSimulation<BoardT>& sim) {
+            const Snake<BoardT>& snake = sim.snake;
+            int head = board.Index(snake.body[0]);
+            int tail = board.Index(snake.body.back());
+            if (sim.food.placed) {
+                BlockBody(snake);
+                if (snake.addSegment) {
+                    blocked[tail] = stamp;
+                }
+                int food = board.Index(sim.food.position);
+                if (Search(head, food)) {
+                    path.clear();
+                    for (int cell = food; cell != head; cell = parent[cell]) {
+                        path.push_back(cell);
+                    }
+                    if (PathKeepsTailReachable(snake)) {
+                        return path.back();
+                    }
+                }
+            }
+            // No safe way to the food: move to the neighbour farthest from the tail that can still reach it
+            const Cell deltas[] = {Cell{0, -1}, Cell{0, 1}, Cell{-1, 0}, Cell{1, 0}};
+            int best = -1, bestDistance = -1, fallback = -1;
+            for (const Cell& delta : deltas) {
+                Cell next = Cell{snake.body[0].x + delta.x, snake.body[0].y + delta.y};
+                BlockBody(snake);
+                // A growing snake leaves its tail in place for one more step
+                if (!Open(next) || (board.Index(next) == tail && snake.addSegment)) {
+                    continue;
+                }
+                fallback = board.Index(next);
+                if (!Search(fallback, tail)) {
+                    continue;
+                }
+                int distance = 0;
+                for (int cell = tail; cell != fallback; cell = parent[cell]) {
+                    distance++;
+                }
+                if (distance > bestDistance) {
+                    best = fallback;
+                    bestDistance = distance;
+                }
+            }
+            return best >= 0 ? best : fallback;
+        }
+
+        // Converts a move from the head to a neighbouring cell into an input.
+        Input MoveTo(const Snake<BoardT>& snake, int index) const {
+            if (index < 0) {
+                return Input::NONE; // Trapped: keep going and let the simulation end the run
+            }
+            Cell head = snake.body[0];
+            Cell next = board.CellAt(index);
+            if (next.y < head.y) {
+                return Input::UP;
+            }
+            if (next.y > head.y) {
+                return Input::DOWN;
+            }
+            return next.x < head.x ? Input::LEFT : Input::RIGHT;
+        }
+
+    public:
+        explicit SolverPolicy(BoardT board = BoardT())
+            : board(board), area(board.Area()), cyclePosition(board.Area(), -1),
+              seen(board.Area(), 0), blocked(board.Area(), 0), parent(board.Area(), 0), queue(board.Area(), 0) {
+            cycleCells.reserve(area);
+            path.reserve(area);
+            BuildCycle();
+        }
+
+        // Forgets the last decision, so the next one checks the body's order from scratch.
+        void Reset() {
+            cycleMode = false;
+            expectedHead = -1;
+            expectedLength = 0;
+        }
+
+        // Returns whether the last decision was taken on the Hamiltonian cycle.
+        bool InCycleMode() const { return cycleMode; }
+
+        // Method to choose the input for the next step
+        Input Decide(const BasicSimulation<BoardT>& sim) {
+            const Snake<BoardT>& snake = sim.snake;
+            grid = &snake.occupancy;
+            // Order is preserved by every cycle-mode move; a restart or another driver breaks it (see Reset())
+            bool continued = cycleMode && board.Index(snake.body[0]) == expectedHead && snake.body.size() >= expectedLength;
+            cycleMode = grid->WallCount() == 0 && (continued || BodyInCycleOrder(snake));
+            int next = cycleMode ? DecideOnCycle(sim) : DecideBySearch(sim);
+            expectedHead = next;
+            expectedLength = snake.body.size();
+            return MoveTo(snake, next);
+        }
+};
+
+#endif // SOLVER_POLICY_H
@@ -0,0 +1,134 @@
+#include "speed_curve.h"
+
+#include <cmath>        // llround for the microsecond periods
+#include <cstdlib>      // strtol/strtod for the points
+#include <fstream>      // Reading curve files
+#include <sstream>      // Splitting lines into fields
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Highest score a curve point may name; keeps the compiled tables small
+static const int maxCurveScore = 1000000;
+
+// Config names of the SpeedLevels, by value
+static const char* const levelNames[4] = {"slow", "medium", "fast", "very_fast"};
+
+SpeedCurve::SpeedCurve(const string& name, const vector<SpeedPoint>& points) : name(name), points(points) {
+    Compile();
+}
+
+void SpeedCurve::Compile() {
+    periods.assign((size_t)(points.back().score / scoreQuantum) + 1, 0);
+    size_t segment = 0; // Last point at or before the current score
+    for (size_t step = 0; step < periods.size(); step++) {
+        int score = (int)step * scoreQuantum;
+        while (segment + 1 < points.size() && points[segment + 1].score <= score) {
+            segment++;
+        }
+        double intervalMs = points[segment].intervalMs;
+        if (score > points[segment].score && segment + 1 < points.size()) {
+            const SpeedPoint& from = points[segment];
+            const SpeedPoint& to = points[segment + 1];
+            intervalMs = from.intervalMs + (to.intervalMs - from.intervalMs) * (score - from.score) / (to.score - from.score);
+        }
+        periods[step] = (uint32_t)llround(intervalMs * 1000.0);
+    }
+}
+
+SpeedCurveSet::SpeedCurveSet() {
+    // Classic game: the base interval minus score / 3000 seconds, down to 50 ms
+    const double baseMs[4] = {220, 170, 140, 70};
+    for (int level = 0; level < 4; level++) {
+        int flatScore = (int)llround((baseMs[level] - 50) * 3);
+        levels[level] = SpeedCurve(levelNames[level], {SpeedPoint{0, baseMs[level]}, SpeedPoint{flatScore, 50}});
+    }
+}
+
+const SpeedCurve* SpeedCurveSet::Find(const string& name) const {
+    for (const SpeedCurve& curve : levels) {
+        if (curve.Name() == name) {
+            return &curve;
+        }
+    }
+    for (const SpeedCurve& curve : custom) {
+        if (curve.Name() == name) {
+            return &curve;
+        }
+    }
+    return nullptr;
+}
+
+// Function to parse one "score:milliseconds" field, returns false if it is malformed or out of range
+static bool ParsePoint(const string& field, SpeedPoint& point) {
+    const char* text = field.c_str();
+    char* end;
+    long score = strtol(text, &end, 10);
+    if (end == text || *end != ':' || score < 0 || score > maxCurveScore) {
+        return false;
+    }
+    text = end + 1;
+    double intervalMs = strtod(text, &end);
+    if (end == text || *end != '\0' || !(intervalMs >= 1.0 && intervalMs <= 60000.0)) {
+        return false;
+    }
+    point = SpeedPoint{(int)score, intervalMs};
+    return true;
+}
+
+bool SpeedCurveSet::Load(const string& path, string& error) {
+    ifstream file(path);
+    if (!file) {
+        error = "cannot read " + path;
+        return false;
+    }
+    SpeedCurveSet loaded; // Levels the file does not name keep their classic curve
+    string line;
+    for (int lineNumber = 1; getline(file, line); lineNumber++) {
+        size_t comment = line.find('#');
+        istringstream fields(line.substr(0, comment));
+        string name, field;
+        if (!(fields >> name)) {
+            continue; // Blank or comment-only line
+        }
+        string where = path + ":" + to_string(lineNumber) + ": ";
+        vector<SpeedPoint> points;
+        while (fields >> field) {
+            SpeedPoint point;
+            if (!ParsePoint(field, point)) {
+                error = where + "'" + field + "' is not score:milliseconds (score 0-" + to_string(maxCurveScore) + ", 1-60000 ms)";
+                return false;
+            }
+            if (!points.empty() && point.score <= points.back().score) {
+                error = where + "scores must increase";
+                return false;
+            }
+            points.push_back(point);
+        }
+        if (points.empty()) {
+            error = where + "curve '" + name + "' has no points";
+            return false;
+        }
+        SpeedCurve curve(name, points);
+        bool replaced = false;
+        for (int level = 0; level < 4; level++) {
+            if (name == levelNames[level]) {
+                loaded.levels[level] = curve;
+                replaced = true;
+            }
+        }
+        if (!replaced) {
+            if (loaded.Find(name) != nullptr) {
+                error = where + "curve '" + name + "' is defined twice";
+                return false;
+            }
+            loaded.custom.push_back(curve);
+        }
+    }
+    *this = loaded;
+    return true;
+}
+
+const SpeedCurveSet& DefaultSpeedCurves() {
+    static const SpeedCurveSet curves;
+    return curves;
+}
@@ -0,0 +1,78 @@
+#ifndef SPEED_CURVE_H
+#define SPEED_CURVE_H
+
+#include <cstdint>      // Integer tick periods
+#include <string>       // Curve names, config paths and error messages
+#include <vector>       // Curve points and compiled tables
+
+// Score gained per food; scores only ever change in these steps, so a table
+// with one entry per step covers every score a run can reach.
+const int scoreQuantum = 10;
+
+// One point of a speed curve: at 'score', a tick lasts 'intervalMs'.
+struct SpeedPoint {
+    int score;
+    double intervalMs;
+};
+
+// Piecewise-linear curve of the tick interval over the score, compiled into a
+// table of integer tick periods (microseconds), one per score step up to the
+// last point; the period is flat before the first point and after the last.
+// Looking a period up is one clamp and one load, no floating point.
+class SpeedCurve {
+    private:
+        std::string name; // Name the curve is configured under
+        std::vector<SpeedPoint> points; // Sorted by score
+        std::vector<uint32_t> periods; // Period at score i * scoreQuantum, in microseconds
+
+        // Recomputes 'periods' from 'points'.
+        void Compile();
+
+    public:
+        SpeedCurve() {}
+        SpeedCurve(const std::string& name, const std::vector<SpeedPoint>& points);
+
+        // Returns the configured name.
+        const std::string& Name() const { return name; }
+
+        // Returns the points the table was compiled from.
+        const std::vector<SpeedPoint>& Points() const { return points; }
+
+        // Returns the tick period at a score, in microseconds.
+        uint32_t PeriodAt(int score) const {
+            size_t step = score > 0 ? (size_t)(score / scoreQuantum) : 0;
+            return periods[step < periods.size() ? step : periods.size() - 1];
+        }
+};
+
+// The curve of each SpeedLevel (indexed by its value) plus any user-defined curves.
+// The defaults reproduce the classic game: 220/170/140/70 ms, 1 ms faster per
+// 3 points, never below 50 ms.
+class SpeedCurveSet {
+    private:
+        SpeedCurve levels[4]; // Curves of SLOW, MEDIUM, FAST and VERY_FAST
+        std::vector<SpeedCurve> custom; // Curves under other names
+
+    public:
+        SpeedCurveSet();
+
+        // Returns the curve of a SpeedLevel, by its value.
+        const SpeedCurve& Level(int level) const { return levels[level]; }
+
+        // Returns a curve by name (a SpeedLevel's "slow", "medium", "fast", "very_fast" or a custom one), null if unknown.
+        const SpeedCurve* Find(const std::string& name) const;
+
+        // Returns the user-defined curves.
+        const std::vector<SpeedCurve>& Custom() const { return custom; }
+
+        // Reads a curve file, one curve per line: a name, then score:milliseconds points in
+        // increasing score order ('#' starts a comment). Named SpeedLevels get the file's curve and
+        // the others the classic one; other names are custom curves. On error, 'error' says where
+        // and the set is left unchanged.
+        bool Load(const std::string& path, std::string& error);
+};
+
+// Returns the curves used when nothing else is configured.
+const SpeedCurveSet& DefaultSpeedCurves();
+
+#endif // SPEED_CURVE_H
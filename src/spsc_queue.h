@@ -0,0 +1,53 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>       // Head and tail indices shared by the two threads
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Each side only writes its own index, so pushing and popping are a
+// load, a store and a release; neither side ever blocks or allocates.
+// Capacity must be a power of two.
+template <typename T, unsigned Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "the capacity must be a power of two");
+
+    private:
+        // The indices sit on separate cache lines so the two threads do not false-share.
+        // Padding instead of alignas keeps heap allocation valid under C++14's operator new.
+        T items[Capacity]; // Ring storage
+        char padHead[64];
+        std::atomic<unsigned> head; // Next slot to pop, written by the consumer
+        char padTail[64 - sizeof(std::atomic<unsigned>)];
+        std::atomic<unsigned> tail; // Next slot to push, written by the producer
+        char padEnd[64 - sizeof(std::atomic<unsigned>)];
+
+    public:
+        SpscQueue() : head(0), tail(0) {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        // Producer side: appends an item, returns false if the queue is full.
+        bool TryPush(const T& item) {
+            unsigned currentTail = tail.load(std::memory_order_relaxed);
+            if (currentTail - head.load(std::memory_order_acquire) == Capacity) {
+                return false;
+            }
+            items[currentTail & (Capacity - 1)] = item;
+            tail.store(currentTail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer side: removes the oldest item, returns false if the queue is empty.
+        bool TryPop(T& item) {
+            unsigned currentHead = head.load(std::memory_order_relaxed);
+            if (currentHead == tail.load(std::memory_order_acquire)) {
+                return false;
+            }
+            item = items[currentHead & (Capacity - 1)];
+            head.store(currentHead + 1, std::memory_order_release);
+            return true;
+        }
+};
+
+#endif // SPSC_QUEUE_H
@@ -0,0 +1,68 @@
+#include "text_cache.h"
+
+#include <algorithm>    // std::max for the block width
+#include <vector>       // Lines of a text block
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+bool CachedText::SetText(const string& text, int fontSize, int lineHeight) {
+    if (!empty && text == key) {
+        return false;
+    }
+    if (lineHeight == 0) {
+        lineHeight = fontSize;
+    }
+
+    // Measure once; the same lines are drawn below
+    vector<string> lines;
+    size_t start = 0;
+    while (start <= text.size()) {
+        size_t end = text.find('\n', start);
+        if (end == string::npos) {
+            end = text.size();
+        }
+        lines.push_back(text.substr(start, end - start));
+        start = end + 1;
+    }
+    int width = 0;
+    for (const string& line : lines) {
+        width = max(width, MeasureText(line.c_str(), fontSize));
+    }
+    int height = (int)(lines.size() - 1) * lineHeight + fontSize;
+
+    return Render(text, width, height, [&] {
+        for (size_t i = 0; i < lines.size(); i++) {
+            DrawText(lines[i].c_str(), 0, (int)i * lineHeight, fontSize, WHITE);
+        }
+    });
+}
+
+void CachedText::Prepare(int width, int height) {
+    empty = width <= 0 || height <= 0;
+    if (loaded && (empty || target.texture.width != width || target.texture.height != height)) {
+        UnloadRenderTexture(target);
+        loaded = false;
+    }
+    if (!empty && !loaded) {
+        target = LoadRenderTexture(width, height);
+        loaded = true;
+    }
+}
+
+void CachedText::Draw(int x, int y, Color tint) const {
+    if (empty) {
+        return;
+    }
+    // Render textures are stored upside down, hence the negative source height
+    Rectangle source = {0, 0, (float)target.texture.width, -(float)target.texture.height};
+    DrawTextureRec(target.texture, source, Vector2{(float)x, (float)y}, tint);
+}
+
+void CachedText::Release() {
+    if (loaded) {
+        UnloadRenderTexture(target);
+        loaded = false;
+    }
+    empty = true;
+    key.clear();
+}
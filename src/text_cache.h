@@ -0,0 +1,57 @@
+#ifndef TEXT_CACHE_H
+#define TEXT_CACHE_H
+
+#include <raylib.h>     // RenderTexture2D and text drawing
+#include <string>       // The cached text
+
+// Text rendered once into a render texture and blitted on later frames, so
+// glyph layout only runs when the content changes. Plain text is rendered in
+// white and takes its color from the tint passed to Draw().
+// Needs a window; must be destroyed before CloseWindow().
+class CachedText {
+    private:
+        RenderTexture2D target; // Rendered content, valid while 'loaded'
+        bool loaded = false; // Whether 'target' holds a texture
+        bool empty = true; // Whether there is nothing to draw
+        std::string key; // Identifies the rendered content
+
+        // Resizes the texture if needed and clears it for drawing.
+        void Prepare(int width, int height);
+
+    public:
+        CachedText() {}
+        ~CachedText() { Release(); }
+
+        CachedText(const CachedText&) = delete;
+        CachedText& operator=(const CachedText&) = delete;
+
+        // Renders lines of text ('\n'-separated, 'lineHeight' pixels apart, 0 = fontSize)
+        // unless the same text is already cached, returns whether it re-rendered.
+        bool SetText(const std::string& text, int fontSize, int lineHeight = 0);
+
+        // Calls draw() into a width x height texture unless 'contentKey' is already cached,
+        // returns whether it re-rendered. draw() uses coordinates relative to the texture.
+        template <typename DrawFn>
+        bool Render(const std::string& contentKey, int width, int height, DrawFn&& draw) {
+            if (!empty && contentKey == key) {
+                return false;
+            }
+            key = contentKey;
+            Prepare(width, height);
+            if (!empty) {
+                BeginTextureMode(target);
+                ClearBackground(BLANK);
+                draw();
+                EndTextureMode();
+            }
+            return true;
+        }
+
+        // Blits the cached content with its top-left corner at (x, y).
+        void Draw(int x, int y, Color tint) const;
+
+        // Unloads the texture.
+        void Release();
+};
+
+#endif // TEXT_CACHE_H
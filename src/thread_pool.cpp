@@ -0,0 +1,99 @@
+#include "thread_pool.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Index of the pool worker running on this thread, -1 outside the pool
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(unsigned threadCount) : queued(0), unfinished(0), nextQueue(0) {
+    if (threadCount == 0) {
+        threadCount = thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1; // hardware_concurrency() may not know
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.emplace_back(new WorkQueue());
+    }
+    for (unsigned i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::Run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread& worker : threads) {
+        worker.join();
+    }
+}
+
+void ThreadPool::Submit(function<void()> task) {
+    unsigned index = currentWorker >= 0 ? (unsigned)currentWorker : nextQueue++ % queues.size();
+    unfinished++;
+    {
+        lock_guard<mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(move(task));
+    }
+    {
+        // Counting under sleepMutex means a worker checking for work cannot miss the wake-up
+        lock_guard<mutex> lock(sleepMutex);
+        queued++;
+    }
+    wake.notify_one();
+}
+
+void ThreadPool::Wait() {
+    unique_lock<mutex> lock(sleepMutex);
+    idle.wait(lock, [this] { return unfinished == 0; });
+}
+
+bool ThreadPool::TryPop(unsigned index, function<void()>& task) {
+    // Own queue first, newest task
+    {
+        WorkQueue& own = *queues[index];
+        lock_guard<mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = move(own.tasks.back());
+            own.tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+    // Then steal the oldest task of the other workers
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkQueue& victim = *queues[(index + offset) % queues.size()];
+        lock_guard<mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = move(victim.tasks.front());
+            victim.tasks.pop_front();
+            queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::Run(unsigned index) {
+    currentWorker = (int)index;
+    function<void()> task;
+    while (true) {
+        if (TryPop(index, task)) {
+            task();
+            task = nullptr; // Release captured state before sleeping
+            if (--unfinished == 0) {
+                lock_guard<mutex> lock(sleepMutex);
+                idle.notify_all();
+            }
+            continue;
+        }
+        unique_lock<mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
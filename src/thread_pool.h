@@ -0,0 +1,59 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>               // Counters shared between workers
+#include <condition_variable>   // Sleeping while there is no work
+#include <deque>                // Per-worker task queues
+#include <functional>           // std::function holding each task
+#include <memory>               // std::unique_ptr for the per-worker queues
+#include <mutex>                // Locks guarding each queue
+#include <thread>               // Worker threads
+#include <vector>               // Worker lists
+
+// Work-stealing thread pool. Every worker owns a queue: it takes its own
+// newest task first (cache-warm, LIFO) and, when that queue is empty, steals
+// the oldest task of another worker (FIFO). Tasks submitted from inside a
+// task go to the submitting worker's own queue.
+class ThreadPool {
+    private:
+        // One worker's queue and the lock guarding it.
+        struct WorkQueue {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkQueue>> queues; // One queue per worker
+        std::vector<std::thread> threads; // The workers
+        std::mutex sleepMutex; // Guards the two condition variables below
+        std::condition_variable wake; // Signalled when work arrives or the pool stops
+        std::condition_variable idle; // Signalled when the last unfinished task completes
+        std::atomic<int> queued; // Tasks sitting in a queue
+        std::atomic<int> unfinished; // Tasks submitted but not completed
+        std::atomic<unsigned> nextQueue; // Round-robin target for outside submissions
+        bool stopping = false; // Set under sleepMutex when the pool shuts down
+
+        // Takes a task from the worker's own queue, or steals one from another queue.
+        bool TryPop(unsigned index, std::function<void()>& task);
+        // Worker thread body.
+        void Run(unsigned index);
+
+    public:
+        // Starts 'threadCount' workers (0 = one per hardware thread).
+        explicit ThreadPool(unsigned threadCount = 0);
+        // Finishes the queued tasks and joins every worker.
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Returns the number of workers.
+        unsigned Size() const { return (unsigned)threads.size(); }
+
+        // Queues a task for any worker.
+        void Submit(std::function<void()> task);
+
+        // Blocks until every submitted task has completed.
+        void Wait();
+};
+
+#endif // THREAD_POOL_H
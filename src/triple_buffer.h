@@ -0,0 +1,53 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <atomic>       // The slot exchanged between the two threads
+
+// Lock-free hand-off of the latest value from one writer thread to one reader
+// thread. The writer fills its back slot and swaps it with the shared middle
+// slot; the reader swaps the middle slot with its front slot when a new value
+// is waiting. Neither side waits for the other, and the reader always sees a
+// complete value.
+template <typename T>
+class TripleBuffer {
+    private:
+        static const unsigned indexMask = 3; // Low bits of 'middle' hold a slot index
+        static const unsigned freshBit = 4; // Set in 'middle' when it holds an unread value
+
+        T slots[3];
+        unsigned back = 0; // Slot owned by the writer
+        std::atomic<unsigned> middle; // Slot in transit, plus freshBit
+        unsigned front = 2; // Slot owned by the reader
+
+    public:
+        TripleBuffer() : middle(1) {}
+
+        TripleBuffer(const TripleBuffer&) = delete;
+        TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+        // Calls init(slot) on every slot; only valid before the two threads start.
+        template <typename Init>
+        void InitAll(Init&& init) {
+            for (T& slot : slots) {
+                init(slot);
+            }
+        }
+
+        // Writer side: the slot to fill before Publish().
+        T& Back() { return slots[back]; }
+
+        // Writer side: makes the back slot the latest value.
+        void Publish() {
+            back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+        }
+
+        // Reader side: switches to the latest published value if there is one, then returns it.
+        const T& Read() {
+            if (middle.load(std::memory_order_relaxed) & freshBit) {
+                front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+            }
+            return slots[front];
+        }
+};
+
+#endif // TRIPLE_BUFFER_H
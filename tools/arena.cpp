@@ -0,0 +1,102 @@
+// Headless arena stress test: many bot snakes on one large shared board,
+// stepped together for a fixed number of ticks. Reports the step cost per
+// tick and per snake, so it shows whether the arena scales with the snake
+// count. The run is reproducible from --seed.
+//
+//   arena [--snakes N] [--board SIZE] [--food F] [--ticks T] [--seed S] [--check]
+
+#include <algorithm>    // std::max for the longest snake
+#include <chrono>       // Wall-clock timing of the run
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // strtoull/atoi for the command line
+#include <cstring>      // strcmp for the command line
+#include <string>       // Invariant error text
+
+#include "arena.h"
+#include "arena_policy.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Command-line settings
+struct Options {
+    int snakes = 1000; // Snakes on the board
+    int board = 512; // Board side length
+    int food = -1; // Food items kept on the board, -1 = one per snake
+    long ticks = 10000; // Steps to play
+    uint64_t seed = 1; // Seed of the arena and the bots
+    bool check = false; // Verify the grid against the snakes after every tick (slow)
+};
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--snakes") == 0 && hasValue) {
+            options.snakes = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            options.board = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--food") == 0 && hasValue) {
+            options.food = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            options.ticks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--check") == 0) {
+            options.check = true;
+        } else {
+            fprintf(stderr, "usage: %s [--snakes N] [--board SIZE] [--food F] [--ticks T] [--seed S] [--check]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.snakes < 1 || !ValidBoardSize(options.board) || options.ticks < 1) {
+        fprintf(stderr, "--snakes and --ticks must be positive and --board between 10 and 4096\n");
+        return 1;
+    }
+
+    Arena arena(options.board, options.seed, options.food < 0 ? options.snakes : options.food);
+    for (int i = 0; i < options.snakes; i++) {
+        arena.AddSnake();
+    }
+    Rng botRng(options.seed ^ 0xB07B07B07ULL);
+
+    long moves = 0, deaths = 0, eaten = 0;
+    int longest = 0;
+    double stepSeconds = 0;
+    string error;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (long t = 0; t < options.ticks; t++) {
+        for (int id = 0; id < arena.SnakeCount(); id++) {
+            if (arena.IsAlive(id)) {
+                arena.Steer(id, ArenaBotPolicy(arena, id, botRng));
+            }
+        }
+        chrono::steady_clock::time_point stepStart = chrono::steady_clock::now();
+        ArenaTickStats stats = arena.Step();
+        stepSeconds += chrono::duration<double>(chrono::steady_clock::now() - stepStart).count();
+        moves += stats.moved;
+        deaths += stats.died;
+        eaten += stats.ate;
+        if (options.check && !arena.CheckInvariants(error)) {
+            fprintf(stderr, "Invariant broken after tick %u: %s\n", arena.Tick(), error.c_str());
+            return 1;
+        }
+        if (t % 256 == 0 || t + 1 == options.ticks) {
+            for (int id = 0; id < arena.SnakeCount(); id++) {
+                longest = max(longest, arena.Length(id));
+            }
+        }
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (!arena.CheckInvariants(error)) {
+        fprintf(stderr, "Invariant broken at the end: %s\n", error.c_str());
+        return 1;
+    }
+
+    printf("Arena: %d snakes, %dx%d board, %d food, %ld ticks, seed %llu\n", options.snakes, options.board,
+           options.board, options.food < 0 ? options.snakes : options.food, options.ticks, (unsigned long long)options.seed);
+    printf("Wall time %.3f s (bots included), %.0f ticks/s\n", elapsed, options.ticks / elapsed);
+    printf("Step      %.2f us/tick, %.1f ns per snake move\n", stepSeconds / options.ticks * 1e6, stepSeconds / (moves > 0 ? moves : 1) * 1e9);
+    printf("Moves %ld, deaths %ld, food eaten %ld, longest snake %d\n", moves, deaths, eaten, longest);
+    printf("Checksum %016llx\n", (unsigned long long)ArenaChecksum(arena));
+    return 0;
+}
@@ -0,0 +1,106 @@
+// Arena client: connects to tools/arenaserver, rebuilds the arena from the
+// snapshot and the per-tick changes, and checks after every tick that its
+// copy matches the server's checksum. With --play it also asks for a snake
+// and steers it with the arena bot, sending tick-stamped inputs.
+//
+//   arenaclient [--host H] [--port P] [--play] [--seed S]
+
+#include <chrono>       // Apply timing
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // strtoull/atoi for the command line
+#include <cstring>      // strcmp for the command line
+#include <string>       // Host name
+#include <vector>       // Message buffers
+
+#include "arena_net.h"
+#include "arena_policy.h"
+#include "net_socket.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+int main(int argc, char** argv) {
+    string host = "127.0.0.1";
+    int port = 7777;
+    bool play = false;
+    uint64_t seed = 2;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--host") == 0 && hasValue) {
+            host = argv[++i];
+        } else if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--play") == 0) {
+            play = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--host H] [--port P] [--play] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    NetConnection server(TcpSocket::Connect(host, port));
+    if (!server.socket.IsOpen()) {
+        fprintf(stderr, "Cannot connect to %s:%d\n", host.c_str(), port);
+        return 1;
+    }
+    vector<uint8_t> message, input;
+    NetWriter(message).Put<uint8_t>(play ? 1 : 0);
+    server.Queue(NET_HELLO, message);
+
+    ArenaMirror mirror;
+    Rng botRng(seed);
+    bool welcomed = false;
+    long ticks = 0, mismatches = 0;
+    uint64_t tickBytes = 0;
+    size_t snapshotBytes = 0;
+    double applySeconds = 0;
+    vector<intptr_t> handles(1, server.socket.Handle());
+    for (;;) {
+        if (!server.Flush()) {
+            break;
+        }
+        WaitForInput(handles, 1000);
+        bool open = server.Pump();
+        uint8_t type;
+        while (server.NextMessage(type, message)) {
+            if (type == NET_WELCOME) {
+                if (!mirror.ApplySnapshot(message)) {
+                    fprintf(stderr, "Malformed snapshot\n");
+                    return 1;
+                }
+                welcomed = true;
+                snapshotBytes = message.size();
+            } else if (type == NET_TICK && welcomed) {
+                bool matches = false;
+                chrono::steady_clock::time_point applyStart = chrono::steady_clock::now();
+                if (!mirror.ApplyTick(message, matches)) {
+                    fprintf(stderr, "Malformed tick message after tick %u\n", mirror.Tick());
+                    return 1;
+                }
+                applySeconds += chrono::duration<double>(chrono::steady_clock::now() - applyStart).count();
+                ticks++;
+                tickBytes += message.size();
+                mismatches += matches ? 0 : 1;
+                int snake = mirror.YourSnake();
+                if (snake >= 0 && mirror.IsAlive(snake)) {
+                    // Stamped with the tick the server plays next
+                    input.clear();
+                    NetWriter writer(input);
+                    writer.Put<uint32_t>(mirror.Tick());
+                    writer.Put<uint8_t>((uint8_t)ArenaBotPolicy(mirror, snake, botRng));
+                    server.Queue(NET_INPUT, input);
+                }
+            }
+        }
+        if (!open) {
+            break; // The server finished or went away
+        }
+    }
+
+    printf("Arena client%s: snapshot %zu bytes, %ld ticks, %.1f bytes/tick, applied in %.2f us/tick\n",
+           play ? " (playing)" : "", snapshotBytes, ticks, ticks > 0 ? (double)tickBytes / ticks : 0.0,
+           ticks > 0 ? applySeconds / ticks * 1e6 : 0.0);
+    printf("Checksum mismatches %ld, final checksum %016llx\n", mismatches, welcomed ? (unsigned long long)ArenaChecksum(mirror) : 0ULL);
+    return mismatches == 0 && welcomed ? 0 : 1;
+}
@@ -0,0 +1,242 @@
+// Authoritative arena server on the loopback interface. Runs an Arena at a
+// fixed tick rate, drives the snakes no client controls with the arena bot,
+// and broadcasts each tick's changes (see src/arena_net.h) to every client.
+// The tick message is encoded once and the same bytes go to every client,
+// so serving another spectator costs one more send, not another encode.
+//
+//   arenaserver [--port P] [--board SIZE] [--bots N] [--food F] [--hz H] [--ticks T] [--wait N] [--seed S]
+
+#include <algorithm>    // std::upper_bound to keep pending inputs in tick order
+#include <chrono>       // Tick scheduling and encode timing
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // strtoull/atoi for the command line
+#include <cstring>      // strcmp for the command line
+#include <deque>        // Pending inputs per client
+#include <memory>       // unique_ptr for clients
+#include <vector>       // Clients and message buffers
+
+#include "arena.h"
+#include "arena_net.h"
+#include "arena_policy.h"
+#include "net_socket.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Command-line settings
+struct Options {
+    int port = 7777; // Loopback port to listen on
+    int board = 256; // Board side length
+    int bots = 200; // Server-driven snakes
+    int food = -1; // Food items kept on the board, -1 = one per bot
+    double hz = 20; // Ticks per second, 0 = as fast as possible
+    long ticks = 1200; // Ticks to play before shutting down
+    int wait = 0; // Clients that must have joined before the first tick
+    uint64_t seed = 1; // Seed of the arena and the bots
+};
+
+// An input waiting for the tick it is stamped with
+struct PendingInput {
+    uint32_t tick;
+    Input input;
+};
+
+// One connected client
+struct Client {
+    NetConnection connection; // Framed socket
+    bool welcomed = false; // Received its snapshot, so it gets tick messages
+    int snake = -1; // Snake it drives, -1 for spectators
+    deque<PendingInput> inputs; // Inputs not applied yet, by tick, then in arrival order
+
+    explicit Client(TcpSocket socket) : connection(move(socket)) {}
+};
+
+static const size_t maxBacklog = 4 << 20; // A client this far behind is disconnected
+static const uint32_t maxInputLead = 64; // Inputs stamped further ahead than this many ticks are dropped
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--port") == 0 && hasValue) {
+            options.port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            options.board = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--bots") == 0 && hasValue) {
+            options.bots = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--food") == 0 && hasValue) {
+            options.food = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--hz") == 0 && hasValue) {
+            options.hz = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--ticks") == 0 && hasValue) {
+            options.ticks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--wait") == 0 && hasValue) {
+            options.wait = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else {
+            fprintf(stderr, "usage: %s [--port P] [--board SIZE] [--bots N] [--food F] [--hz H] [--ticks T] [--wait N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (!ValidBoardSize(options.board) || options.bots < 0 || options.ticks < 1 || options.hz < 0) {
+        fprintf(stderr, "--board must be between 10 and 4096, --ticks positive, --bots and --hz not negative\n");
+        return 1;
+    }
+
+    TcpSocket listener = TcpSocket::Listen(options.port);
+    if (!listener.IsOpen()) {
+        fprintf(stderr, "Cannot listen on 127.0.0.1:%d\n", options.port);
+        return 1;
+    }
+    printf("Listening on 127.0.0.1:%d\n", options.port);
+    fflush(stdout);
+
+    Arena arena(options.board, options.seed, options.food < 0 ? options.bots : options.food);
+    for (int i = 0; i < options.bots; i++) {
+        arena.AddSnake();
+    }
+    vector<uint8_t> driven(arena.SnakeCount(), 0); // Per snake, whether a client steers it
+    Rng botRng(options.seed ^ 0xB07B07B07ULL);
+    ArenaDeltaEncoder encoder;
+    encoder.Capture(arena);
+
+    vector<unique_ptr<Client>> clients;
+    vector<uint8_t> payload, message;
+    vector<intptr_t> handles;
+    int joined = 0;
+    long lateInputs = 0, appliedInputs = 0, futureInputs = 0, dropped = 0;
+    uint64_t tickBytes = 0, sentBytes = 0;
+    size_t largestTick = 0;
+    double encodeSeconds = 0;
+    const chrono::steady_clock::duration interval = options.hz > 0
+        ? chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(1.0 / options.hz))
+        : chrono::steady_clock::duration::zero();
+    chrono::steady_clock::time_point nextTick = chrono::steady_clock::now();
+    chrono::steady_clock::time_point start = nextTick;
+
+    while (arena.Tick() < (uint32_t)options.ticks) {
+        // Sleep in poll() until a client sends something or the next tick is due
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        int timeoutMs = joined < options.wait ? 100 : (int)chrono::duration_cast<chrono::milliseconds>(nextTick - now).count();
+        handles.assign(1, listener.Handle());
+        for (const unique_ptr<Client>& client : clients) {
+            handles.push_back(client->connection.socket.Handle());
+        }
+        if (timeoutMs > 0) {
+            WaitForInput(handles, timeoutMs);
+        }
+
+        for (TcpSocket socket = listener.Accept(); socket.IsOpen(); socket = listener.Accept()) {
+            clients.emplace_back(new Client(move(socket)));
+        }
+
+        for (size_t i = 0; i < clients.size();) {
+            Client& client = *clients[i];
+            bool open = client.connection.Pump();
+            uint8_t type;
+            while (open && client.connection.NextMessage(type, message)) {
+                NetReader reader(message);
+                if (type == NET_HELLO && !client.welcomed) {
+                    if (reader.Get<uint8_t>()) {
+                        client.snake = arena.AddSnake();
+                        driven.push_back(1);
+                    }
+                    encoder.EncodeSnapshot(arena, client.snake, payload);
+                    client.connection.Queue(NET_WELCOME, payload);
+                    client.welcomed = true;
+                    joined++;
+                } else if (type == NET_INPUT && client.snake >= 0) {
+                    uint32_t tick = reader.Get<uint32_t>();
+                    uint8_t input = reader.Get<uint8_t>();
+                    if (!reader.ok || input > (uint8_t)Input::RIGHT) {
+                        continue;
+                    }
+                    if (tick > arena.Tick() + maxInputLead) {
+                        futureInputs++; // Would hold the client's later turns back for too long
+                        continue;
+                    }
+                    // Keyed by tick, so an input stamped ahead never delays one stamped earlier
+                    auto position = upper_bound(client.inputs.begin(), client.inputs.end(), tick,
+                                                [](uint32_t value, const PendingInput& pending) { return value < pending.tick; });
+                    client.inputs.insert(position, PendingInput{tick, (Input)input});
+                }
+            }
+            if (!open || !client.connection.Flush()) {
+                if (client.snake >= 0) {
+                    driven[client.snake] = 0; // The bot takes over an abandoned snake
+                }
+                clients.erase(clients.begin() + i);
+                dropped++;
+                continue;
+            }
+            i++;
+        }
+
+        if (joined < options.wait) {
+            nextTick = chrono::steady_clock::now();
+            start = nextTick;
+            continue;
+        }
+        if (chrono::steady_clock::now() < nextTick) {
+            continue;
+        }
+        nextTick += interval;
+
+        // Apply every input stamped for this tick or earlier, oldest tick first
+        for (const unique_ptr<Client>& client : clients) {
+            while (!client->inputs.empty() && client->inputs.front().tick <= arena.Tick()) {
+                lateInputs += client->inputs.front().tick < arena.Tick() ? 1 : 0;
+                appliedInputs++;
+                arena.Steer(client->snake, client->inputs.front().input);
+                client->inputs.pop_front();
+            }
+        }
+        for (int id = 0; id < arena.SnakeCount(); id++) {
+            if (!driven[id] && arena.IsAlive(id)) {
+                arena.Steer(id, ArenaBotPolicy(arena, id, botRng));
+            }
+        }
+        arena.Step();
+
+        chrono::steady_clock::time_point encodeStart = chrono::steady_clock::now();
+        encoder.EncodeTick(arena, payload);
+        encodeSeconds += chrono::duration<double>(chrono::steady_clock::now() - encodeStart).count();
+        tickBytes += payload.size();
+        largestTick = payload.size() > largestTick ? payload.size() : largestTick;
+
+        for (size_t i = 0; i < clients.size();) {
+            Client& client = *clients[i];
+            if (client.welcomed) {
+                client.connection.Queue(NET_TICK, payload);
+                sentBytes += payload.size() + 5;
+            }
+            if (!client.connection.Flush() || client.connection.Backlog() > maxBacklog) {
+                if (client.snake >= 0) {
+                    driven[client.snake] = 0;
+                }
+                clients.erase(clients.begin() + i);
+                dropped++;
+                continue;
+            }
+            i++;
+        }
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // Hand the last ticks to the kernel before closing, giving slow clients up to a second
+    chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::seconds(1);
+    for (const unique_ptr<Client>& client : clients) {
+        while (client->connection.Flush() && client->connection.Backlog() > 0 && chrono::steady_clock::now() < deadline) {
+            WaitForInput(vector<intptr_t>(), 1);
+        }
+    }
+
+    printf("Arena server: %ld ticks in %.2f s, %dx%d board, %d snakes, %d clients joined (%ld dropped)\n",
+           options.ticks, elapsed, options.board, options.board, arena.SnakeCount(), joined, dropped);
+    printf("Tick message: %.1f bytes average, %zu largest, encoded in %.2f us average\n",
+           (double)tickBytes / options.ticks, largestTick, encodeSeconds / options.ticks * 1e6);
+    printf("Sent %.1f KiB to clients, %ld inputs applied (%ld late, %ld dropped as too far ahead)\n", sentBytes / 1024.0,
+           appliedInputs, lateInputs, futureInputs);
+    printf("Checksum %016llx\n", (unsigned long long)ArenaChecksum(arena));
+    return 0;
+}
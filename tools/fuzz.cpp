@@ -0,0 +1,688 @@
+// Deterministic fuzzer for the game state machine. Every case derives a board
+// (size, random walls) and a sequence of operations from --seed and its case
+// number: steps with a bot's, random or no input, difficulty changes (queued
+// and immediate), restarts and SaveState/LoadState round trips. After every
+// operation the simulation is checked: body length and shape, no overlap, food
+// never on the body or a wall, the tick period and the outcome of each step;
+// every --full-check operations (and at the end) the whole board is also
+// recounted from the body and walls against the occupancy grid and the spawn
+// set. Each sequence is then replayed on a fresh simulation, which must end
+// in the same state, and the games it finished go through a scratch
+// leaderboard whose top lists must stay sorted and survive a reopen and an
+// index rebuild.
+// A failing sequence is shrunk to a minimal one that still fails the same
+// check and printed with the case; `--case N` reruns a single case.
+//
+//   fuzz [--cases N] [--ops N] [--threads T] [--seed S] [--board SIZE] [--full-check N] [--case N] [--scratch DIR]
+
+#include <algorithm>    // std::equal/sort/min for the reference lists
+#include <chrono>       // Wall-clock timing of the run
+#include <cstdio>       // printf/fprintf/remove for the report and scratch files
+#include <cstdlib>      // strtoull/atoi for the command line
+#include <cstring>      // strcmp for the command line
+#include <string>       // Failure messages
+#include <vector>       // Operation sequences and results
+
+#include "greedy_policy.h"
+#include "leaderboard.h"
+#include "simulation.h"
+#include "solver_policy.h"
+#include "thread_pool.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// What one operation does to the simulation
+enum class OpKind : uint8_t {
+    STEP, // Step(value as Input)
+    CHANGE_DIFFICULTY, // ChangeDifficulty(value as SpeedLevel)
+    SET_DIFFICULTY, // SetDifficulty(value as SpeedLevel)
+    RESTART, // Restart(seed, value as SpeedLevel)
+    SAVE_LOAD // SaveState, LoadState into a second simulation and back
+};
+
+// One operation of a case; sequences are recorded, so replaying them needs no policy
+struct Op {
+    OpKind kind;
+    uint8_t value; // Input or SpeedLevel
+    uint32_t seed; // Seed of a RESTART
+};
+
+// Board and start of a case, derived from the case seed
+struct CaseSetup {
+    uint64_t seed; // Case seed, also drives the operation picks
+    int boardSize; // Cells along each side
+    SpeedLevel level; // Starting difficulty
+    int wallPercent; // Share of walls, 0 for an open board
+    vector<uint8_t> wallBits; // Row-major wall bitmap (empty for none)
+    bool solver; // The bot is SolverPolicy instead of GreedyPolicy
+    int noise; // Per-mille of steps with a random input instead of the bot's
+};
+
+// Outcome of running a sequence
+struct RunResult {
+    bool ok = true; // False once a check failed
+    size_t failedAt = 0; // Index of the operation after which the check failed
+    string error; // "check: details"
+    uint64_t digest = 14695981039346656037ull; // Hash of every step's events and of the final state
+    long steps = 0; // Step operations run
+    int boardsFilled = 0; // Steps that reported EVENT_BOARD_FULL
+    vector<pair<int, SpeedLevel>> finished; // Final score and level of every game that ended
+};
+
+// Outcome of one case, as reported
+struct CaseReport {
+    long ops = 0; // Operations run
+    long steps = 0; // Step operations run
+    int games = 0; // Games that ended
+    int boardsFilled = 0; // Steps with no free spawn cell
+    bool ok = true;
+    string report; // Failure description with the shrunk sequence
+};
+
+// Command-line settings
+struct Options {
+    int cases = 256; // Cases to run
+    int ops = 20000; // Operations generated per case
+    unsigned threads = 0; // Worker threads, 0 = one per hardware thread
+    uint64_t seed = 1; // Base seed of the whole run
+    int board = 0; // Board side length, 0 = a different one per case
+    int fullCheck = 64; // Operations between two full board recounts, 1 = after every one
+    int onlyCase = -1; // Run only this case
+    string scratch = "."; // Directory of the scratch leaderboard files
+};
+
+static const int boardSizes[] = {10, 12, 17, 29, 64}; // Picked from when --board is not given
+static const int leaderboardCapacity = 8; // Small, so the fuzzed games keep evicting entries
+static const int maxLeaderboardGames = 200; // Games of a case written to the scratch leaderboard
+static const char* const inputNames[] = {"none", "up", "down", "left", "right"};
+static const char* const levelNames[] = {"slow", "medium", "fast", "very_fast"};
+
+// Function to derive an independent seed for one case
+static uint64_t CaseSeed(uint64_t baseSeed, int caseNumber) {
+    Rng mixer(baseSeed ^ ((uint64_t)caseNumber << 32));
+    return mixer.Next();
+}
+
+// Function to derive the board and start of a case
+static CaseSetup MakeSetup(const Options& options, int caseNumber) {
+    CaseSetup setup;
+    setup.seed = CaseSeed(options.seed, caseNumber);
+    Rng rng(setup.seed);
+    int sizeCount = (int)(sizeof(boardSizes) / sizeof(boardSizes[0]));
+    setup.boardSize = options.board > 0 ? options.board : boardSizes[rng.GetRandomValue(0, sizeCount - 1)];
+    setup.level = (SpeedLevel)rng.GetRandomValue(0, 3);
+    setup.wallPercent = rng.GetRandomValue(0, 1) == 0 ? 0 : rng.GetRandomValue(1, 15);
+    setup.solver = rng.GetRandomValue(0, 2) == 0;
+    const int noiseLevels[] = {0, 10, 200};
+    setup.noise = noiseLevels[rng.GetRandomValue(0, 2)];
+    if (setup.wallPercent > 0) {
+        const int size = setup.boardSize;
+        setup.wallBits.assign(((size_t)size * size + 7) / 8, 0);
+        for (int y = 0; y < size; y++) {
+            if (y == LevelRules().start.y) {
+                continue; // The starting snake must be on free cells
+            }
+            for (int x = 0; x < size; x++) {
+                if (rng.GetRandomValue(0, 99) < setup.wallPercent) {
+                    int index = y * size + x;
+                    setup.wallBits[index >> 3] |= (uint8_t)(1 << (index & 7));
+                }
+            }
+        }
+    }
+    return setup;
+}
+
+// Function to compare two states field by field
+static bool SameState(const SimulationState& a, const SimulationState& b) {
+    return a.rngState == b.rngState && a.speedLevel == b.speedLevel &&
+           a.difficultyHasChanged == b.difficultyHasChanged && a.newDifficulty == b.newDifficulty &&
+           a.body.size() == b.body.size() && equal(a.body.begin(), a.body.end(), b.body.begin()) &&
+           a.direction == b.direction && a.addSegment == b.addSegment && a.foodPosition == b.foodPosition &&
+           a.foodPlaced == b.foodPlaced && a.running == b.running && a.score == b.score &&
+           a.lastScore == b.lastScore && a.foodEaten == b.foodEaten && a.freeSpawnCells == b.freeSpawnCells;
+}
+
+// Function to fold a value into an FNV-1a hash
+static uint64_t Mix(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Function to format one operation
+static string OpText(const Op& op) {
+    switch (op.kind) {
+        case OpKind::STEP:              return string("step ") + inputNames[op.value];
+        case OpKind::CHANGE_DIFFICULTY: return string("change-difficulty ") + levelNames[op.value];
+        case OpKind::SET_DIFFICULTY:    return string("set-difficulty ") + levelNames[op.value];
+        case OpKind::RESTART:           return "restart " + to_string(op.seed) + " " + levelNames[op.value];
+        case OpKind::SAVE_LOAD:         return "save-load";
+    }
+    return "?";
+}
+
+// Function to recount the board from the body and walls and compare it with the occupancy grid and the spawn set
+template <typename BoardT, typename InSpawnArea>
+static bool CheckBoard(const BasicSimulation<BoardT>& sim, InSpawnArea&& inSpawnArea, string& error) {
+    const OccupancyGrid<BoardT>& grid = sim.snake.occupancy;
+    const BoardT& board = sim.GetBoard();
+    const SnakeBody& body = sim.snake.body;
+    vector<int> counts((size_t)board.Area(), 0);
+    for (int i = 0; i < board.Area(); i++) {
+        counts[i] = grid.IsWall(board.CellAt(i)) ? 1 : 0;
+    }
+    for (size_t i = 0; i < body.size(); i++) {
+        Cell cell = body[i];
+        if (!board.Contains(cell)) {
+            error = "body: segment " + to_string(i) + " is off the board";
+            return false;
+        }
+        if (i > 0) {
+            Cell previous = body[i - 1];
+            if (abs(cell.x - previous.x) + abs(cell.y - previous.y) != 1) {
+                error = "body: segments " + to_string(i - 1) + " and " + to_string(i) + " are not adjacent";
+                return false;
+            }
+        }
+        counts[board.Index(cell)]++;
+    }
+    int freeInArea = 0;
+    for (int i = 0; i < board.Area(); i++) {
+        Cell cell = board.CellAt(i);
+        if (counts[i] > 1) {
+            error = "overlap: " + to_string(counts[i]) + " segments or walls on (" + to_string(cell.x) + ", " + to_string(cell.y) + ")";
+            return false;
+        }
+        if (grid.Count(cell) != counts[i]) {
+            error = "grid: (" + to_string(cell.x) + ", " + to_string(cell.y) + ") counts " + to_string(grid.Count(cell)) +
+                    ", the body and walls give " + to_string(counts[i]);
+            return false;
+        }
+        freeInArea += counts[i] == 0 && inSpawnArea(cell) ? 1 : 0;
+    }
+
+    // The spawn set holds exactly the empty cells inside the current difficulty's margin
+    const FreeCellSet& freeCells = grid.FreeSpawnCells();
+    if (freeCells.Size() != freeInArea) {
+        error = "spawn-set: " + to_string(freeCells.Size()) + " members, " + to_string(freeInArea) + " free cells in the margin";
+        return false;
+    }
+    for (int slot = 0; slot < freeCells.Size(); slot++) {
+        int index = freeCells.At(slot);
+        if (index < 0 || index >= board.Area() || counts[index] != 0 || !inSpawnArea(board.CellAt(index))) {
+            error = "spawn-set: member " + to_string(index) + " is not a free cell in the margin";
+            return false;
+        }
+    }
+    return true;
+}
+
+// Function to check the simulation against its invariants, returns false (with 'error') on a failure.
+// The constant-time checks run every time; 'full' adds CheckBoard()'s recount of the whole board.
+template <typename BoardT>
+static bool CheckInvariants(const BasicSimulation<BoardT>& sim, bool full, string& error) {
+    const OccupancyGrid<BoardT>& grid = sim.snake.occupancy;
+    const BoardT& board = sim.GetBoard();
+    const int size = board.CellCount();
+    const SnakeBody& body = sim.snake.body;
+
+    // One segment per food on top of the start, one of which may still be pending
+    if (sim.score < 0 || sim.score % scoreQuantum != 0) {
+        error = "score: " + to_string(sim.score) + " is not a multiple of " + to_string(scoreQuantum);
+        return false;
+    }
+    int expectedLength = sim.snake.startLength + sim.score / scoreQuantum - (sim.snake.addSegment ? 1 : 0);
+    if ((int)body.size() != expectedLength) {
+        error = "length: " + to_string(body.size()) + " segments, expected " + to_string(expectedLength) +
+                " for score " + to_string(sim.score);
+        return false;
+    }
+    Cell head = body[0];
+    if (!board.Contains(head) || grid.Count(head) != 1) {
+        error = "overlap: the head shares its cell with another segment or a wall";
+        return false;
+    }
+    if (body.size() > 1) {
+        Cell neck = body[1];
+        if (abs(head.x - neck.x) + abs(head.y - neck.y) != 1) {
+            error = "body: the head is not next to the neck";
+            return false;
+        }
+    }
+    const int margin = sim.food.GetMinDistance();
+    auto inSpawnArea = [&](Cell cell) {
+        return cell.x >= margin && cell.y >= margin && cell.x < size - margin && cell.y < size - margin;
+    };
+    if (full && !CheckBoard(sim, inSpawnArea, error)) {
+        return false;
+    }
+
+    const FreeCellSet& freeCells = grid.FreeSpawnCells();
+    if (sim.food.placed) {
+        Cell food = sim.food.position;
+        if (!board.Contains(food) || grid.Count(food) != 0 || !inSpawnArea(food)) {
+            error = "food: (" + to_string(food.x) + ", " + to_string(food.y) + ") is on the body, a wall or outside the margin";
+            return false;
+        }
+    } else if (!freeCells.Empty()) {
+        error = "food: not placed although " + to_string(freeCells.Size()) + " spawn cells are free";
+        return false;
+    }
+
+    if (sim.GetTickPeriod() != DefaultSpeedCurves().Level((int)sim.speedLevel).PeriodAt(sim.score)) {
+        error = "tick-period: " + to_string(sim.GetTickPeriod()) + " us does not match the curve at score " + to_string(sim.score);
+        return false;
+    }
+    // Only a game over stops the game, and it puts the snake back at the start
+    if (!sim.running && (sim.score != 0 || body.size() != (size_t)sim.snake.startLength || !(head == sim.snake.start))) {
+        error = "stopped: a stopped game is not at its start";
+        return false;
+    }
+    return true;
+}
+
+// Runs operations on a simulation and its SaveState/LoadState partner, checking after each one.
+template <typename BoardT>
+class Runner {
+    private:
+        const CaseSetup& setup;
+        int fullCheck; // Operations between two full checks
+        long applied = 0; // Operations applied so far
+        BasicSimulation<BoardT> sim; // Simulation under test
+        BasicSimulation<BoardT> partner; // Receives the SAVE_LOAD round trips
+        SimulationState saved, reloaded; // Reused by SAVE_LOAD
+
+        // Puts a simulation on the case's board.
+        void Prepare(BasicSimulation<BoardT>& target) {
+            if (!setup.wallBits.empty()) {
+                target.SetLevel(LevelRules(), setup.wallBits.data());
+                target.Restart(setup.seed, setup.level);
+            }
+        }
+
+        // Checks what a step reported against the states before and after it.
+        bool CheckStep(unsigned events, int scoreBefore, int& finishedScore, string& error) {
+            finishedScore = -1;
+            if (events & EVENT_GAME_OVER) {
+                if (!(events & (EVENT_HIT_WALL | EVENT_HIT_TAIL | EVENT_HIT_OBSTACLE)) || sim.running || sim.score != 0) {
+                    error = "event: game over without a collision, or the game still runs";
+                    return false;
+                }
+                int expected = scoreBefore + ((events & EVENT_ATE_FOOD) ? scoreQuantum : 0);
+                if (sim.lastScore != expected) {
+                    error = "event: last score " + to_string(sim.lastScore) + ", expected " + to_string(expected);
+                    return false;
+                }
+                finishedScore = sim.lastScore;
+            } else if (events & (EVENT_HIT_WALL | EVENT_HIT_TAIL | EVENT_HIT_OBSTACLE)) {
+                error = "event: a collision did not end the game";
+                return false;
+            } else if (sim.score != scoreBefore + ((events & EVENT_ATE_FOOD) ? scoreQuantum : 0)) {
+                error = "event: score went from " + to_string(scoreBefore) + " to " + to_string(sim.score);
+                return false;
+            }
+            return true;
+        }
+
+    public:
+        RunResult result;
+
+        Runner(const CaseSetup& setup, BoardT board, int fullCheck)
+            : setup(setup), fullCheck(fullCheck), sim(setup.seed, setup.level, board), partner(setup.seed, setup.level, board) {
+            Prepare(sim);
+            Prepare(partner);
+        }
+
+        // Returns the simulation under test.
+        const BasicSimulation<BoardT>& Sim() const { return sim; }
+
+        // Method to apply one operation and check the result, returns false (with result.error) on a failure
+        bool Apply(const Op& op) {
+            string error;
+            bool ok = true;
+            switch (op.kind) {
+                case OpKind::STEP: {
+                    int scoreBefore = sim.score;
+                    SpeedLevel levelBefore = sim.speedLevel;
+                    unsigned events = sim.Step((Input)op.value);
+                    result.digest = Mix(result.digest, events);
+                    result.steps++;
+                    result.boardsFilled += (events & EVENT_BOARD_FULL) ? 1 : 0;
+                    int finishedScore;
+                    ok = CheckStep(events, scoreBefore, finishedScore, error);
+                    if (ok && finishedScore >= 0) {
+                        result.finished.push_back(make_pair(finishedScore, levelBefore));
+                    }
+                    break;
+                }
+                case OpKind::CHANGE_DIFFICULTY:
+                    sim.ChangeDifficulty((SpeedLevel)op.value);
+                    break;
+                case OpKind::SET_DIFFICULTY:
+                    sim.SetDifficulty((SpeedLevel)op.value);
+                    break;
+                case OpKind::RESTART:
+                    sim.Restart(op.seed, (SpeedLevel)op.value);
+                    break;
+                case OpKind::SAVE_LOAD:
+                    sim.SaveState(saved);
+                    partner.LoadState(saved);
+                    partner.SaveState(reloaded);
+                    if (!SameState(saved, reloaded)) {
+                        error = "save-load: the loaded state saves differently";
+                        ok = false;
+                    } else if (!CheckInvariants(partner, true, error)) {
+                        error = "save-load: loaded " + error;
+                        ok = false;
+                    } else {
+                        sim.LoadState(reloaded);
+                    }
+                    break;
+            }
+            if (ok) {
+                ok = CheckInvariants(sim, ++applied % fullCheck == 0, error);
+            }
+            if (!ok) {
+                result.ok = false;
+                result.error = error;
+            }
+            return ok;
+        }
+
+        // Method to run the full check on the final state, returns false (with result.error) on a failure
+        bool CheckFinal() {
+            if (!CheckInvariants(sim, true, result.error)) {
+                result.ok = false;
+            }
+            return result.ok;
+        }
+
+        // Method to fold the final state into the digest
+        void Finish() {
+            sim.SaveState(saved);
+            uint64_t hash = Mix(result.digest, saved.rngState);
+            hash = Mix(hash, ((uint64_t)sim.score << 32) | (uint32_t)sim.lastScore);
+            for (const Cell& cell : saved.body) {
+                hash = Mix(hash, ((uint64_t)(uint32_t)cell.x << 32) | (uint32_t)cell.y);
+            }
+            for (int index : saved.freeSpawnCells) {
+                hash = Mix(hash, (uint64_t)index);
+            }
+            result.digest = hash;
+        }
+};
+
+// Function to run a recorded sequence on a fresh simulation
+template <typename BoardT>
+static RunResult Run(const CaseSetup& setup, BoardT board, int fullCheck, const vector<Op>& ops) {
+    Runner<BoardT> runner(setup, board, fullCheck);
+    for (size_t i = 0; i < ops.size(); i++) {
+        if (!runner.Apply(ops[i])) {
+            runner.result.failedAt = i;
+            return runner.result;
+        }
+    }
+    if (!runner.CheckFinal()) {
+        runner.result.failedAt = ops.empty() ? 0 : ops.size() - 1;
+        return runner.result;
+    }
+    runner.Finish();
+    return runner.result;
+}
+
+// Function to pick, apply and record the operations of a case
+template <typename BoardT>
+static RunResult Generate(const CaseSetup& setup, BoardT board, int count, int fullCheck, vector<Op>& ops) {
+    Runner<BoardT> runner(setup, board, fullCheck);
+    SolverPolicy<BoardT> solver(board);
+    Rng rng(setup.seed ^ 0x9E3779B97F4A7C15ull);
+    ops.clear();
+    ops.reserve(count);
+    for (int i = 0; i < count; i++) {
+        Op op = {OpKind::STEP, 0, 0};
+        int roll = rng.GetRandomValue(0, 9999);
+        if (roll < 100) {
+            op = Op{OpKind::CHANGE_DIFFICULTY, (uint8_t)rng.GetRandomValue(0, 3), 0};
+        } else if (roll < 120) {
+            op = Op{OpKind::SET_DIFFICULTY, (uint8_t)rng.GetRandomValue(0, 3), 0};
+        } else if (roll < 125) {
+            op = Op{OpKind::RESTART, (uint8_t)rng.GetRandomValue(0, 3), (uint32_t)rng.Next()};
+            solver.Reset();
+        } else if (roll < 175) {
+            op = Op{OpKind::SAVE_LOAD, 0, 0};
+        } else if (rng.GetRandomValue(0, 999) < setup.noise) {
+            op.value = (uint8_t)rng.GetRandomValue(0, 4);
+            solver.Reset(); // The solver did not drive this step
+        } else {
+            op.value = (uint8_t)(setup.solver ? solver.Decide(runner.Sim()) : GreedyPolicy(runner.Sim()));
+        }
+        ops.push_back(op);
+        if (!runner.Apply(op)) {
+            runner.result.failedAt = ops.size() - 1;
+            return runner.result;
+        }
+    }
+    if (!runner.CheckFinal()) {
+        runner.result.failedAt = ops.size() - 1;
+        return runner.result;
+    }
+    runner.Finish();
+    return runner.result;
+}
+
+// Function to return the check name of a failure ("length", "overlap", ...)
+static string CheckName(const string& error) {
+    return error.substr(0, error.find(':'));
+}
+
+// Function to shrink a failing sequence: drops ever smaller chunks of operations, then turns
+// the remaining steps into plain ones, as long as the sequence still fails the same check
+template <typename Fails>
+static vector<Op> Shrink(vector<Op> ops, Fails&& fails) {
+    for (size_t chunk = ops.size() / 2; chunk >= 1; chunk /= 2) {
+        for (size_t start = 0; start < ops.size();) {
+            vector<Op> candidate(ops.begin(), ops.begin() + start);
+            candidate.insert(candidate.end(), ops.begin() + min(start + chunk, ops.size()), ops.end());
+            if (fails(candidate)) {
+                ops = candidate;
+            } else {
+                start += chunk;
+            }
+        }
+    }
+    for (Op& op : ops) {
+        if (op.kind == OpKind::STEP && op.value != (uint8_t)Input::NONE) {
+            Op original = op;
+            op.value = (uint8_t)Input::NONE;
+            if (!fails(ops)) {
+                op = original;
+            }
+        }
+    }
+    return ops;
+}
+
+// Function to describe a failure and its shrunk sequence
+static string FailureReport(int caseNumber, const CaseSetup& setup, const string& error, const vector<Op>& ops) {
+    string report = "case " + to_string(caseNumber) + " (" + to_string(setup.boardSize) + "x" + to_string(setup.boardSize) +
+                    " board, " + to_string(setup.wallPercent) + "% walls, " + levelNames[(int)setup.level] + "): " + error + "\n";
+    report += "  minimal sequence (" + to_string(ops.size()) + " ops):\n";
+    for (size_t i = 0; i < ops.size(); i++) {
+        report += "    " + to_string(i) + ": " + OpText(ops[i]) + "\n";
+    }
+    return report;
+}
+
+// Function to check a scratch leaderboard fed with the games of a case, returns false (with 'error') on a failure
+static bool CheckLeaderboard(const string& scratch, int caseNumber, const vector<pair<int, SpeedLevel>>& finished, string& error) {
+    string logPath = scratch + "/fuzz-" + to_string(caseNumber) + ".log";
+    string indexPath = scratch + "/fuzz-" + to_string(caseNumber) + ".idx";
+    remove(logPath.c_str());
+    remove(indexPath.c_str());
+    vector<int> expected[leaderboardLevels]; // Every score fed in, per level
+    bool ok = true;
+    {
+        Leaderboard leaderboard(leaderboardCapacity);
+        if (!leaderboard.Open(logPath, indexPath)) {
+            error = "leaderboard: cannot open " + logPath;
+            return false;
+        }
+        size_t games = min(finished.size(), (size_t)maxLeaderboardGames);
+        for (size_t i = 0; i < games && ok; i++) {
+            ok = leaderboard.Add("case" + to_string(caseNumber), finished[i].first, finished[i].second, (int64_t)i);
+            expected[(int)finished[i].second].push_back(finished[i].first);
+        }
+        if (!ok) {
+            error = "leaderboard: Add failed";
+        }
+    }
+    for (vector<int>& scores : expected) {
+        sort(scores.begin(), scores.end(), [](int a, int b) { return a > b; });
+        scores.resize(min(scores.size(), (size_t)leaderboardCapacity));
+    }
+    // Reopened from the index, then rebuilt from the log alone
+    for (int pass = 0; pass < 2 && ok; pass++) {
+        if (pass == 1) {
+            remove(indexPath.c_str());
+        }
+        Leaderboard leaderboard(leaderboardCapacity);
+        if (!leaderboard.Open(logPath, indexPath)) {
+            error = "leaderboard: cannot reopen " + logPath;
+            ok = false;
+            break;
+        }
+        for (int level = 0; level < leaderboardLevels && ok; level++) {
+            vector<LeaderboardEntry> top = leaderboard.Top((SpeedLevel)level, leaderboardCapacity + 1);
+            for (size_t i = 0; i < top.size() && ok; i++) {
+                bool sorted = i == 0 || top[i - 1].score > top[i].score ||
+                              (top[i - 1].score == top[i].score && top[i - 1].record < top[i].record);
+                if (!sorted || top[i].level != (SpeedLevel)level) {
+                    error = string("leaderboard: ") + levelNames[level] + " list out of order at row " + to_string(i);
+                    ok = false;
+                }
+            }
+            if (ok && (top.size() != expected[level].size() ||
+                       !equal(top.begin(), top.end(), expected[level].begin(),
+                              [](const LeaderboardEntry& entry, int score) { return entry.score == score; }))) {
+                error = string("leaderboard: ") + levelNames[level] + " list differs from the best scores fed in" +
+                        (pass == 0 ? " (index)" : " (rebuilt)");
+                ok = false;
+            }
+        }
+    }
+    remove(logPath.c_str());
+    remove(indexPath.c_str());
+    return ok;
+}
+
+// Function to run one case: generate, replay, shrink on a failure, check the leaderboard
+template <typename BoardT>
+static CaseReport RunCase(BoardT board, const CaseSetup& setup, int caseNumber, const Options& options) {
+    CaseReport report;
+    vector<Op> ops;
+    RunResult generated = Generate(setup, board, options.ops, options.fullCheck, ops);
+    report.ops = (long)ops.size();
+    report.steps = generated.steps;
+    report.games = (int)generated.finished.size();
+    report.boardsFilled = generated.boardsFilled;
+
+    string error = generated.error;
+    if (generated.ok) {
+        RunResult replayed = Run(setup, board, options.fullCheck, ops);
+        if (!replayed.ok || replayed.digest != generated.digest) {
+            error = "determinism: the replayed sequence " + (replayed.ok ? string("ends in another state") : "fails: " + replayed.error);
+        }
+    }
+    if (!error.empty()) {
+        string check = CheckName(error);
+        vector<Op> minimal;
+        if (check == "determinism") {
+            minimal = Shrink(ops, [&](const vector<Op>& candidate) {
+                RunResult first = Run(setup, board, options.fullCheck, candidate);
+                RunResult second = Run(setup, board, options.fullCheck, candidate);
+                return first.ok != second.ok || first.digest != second.digest;
+            });
+        } else {
+            minimal = Shrink(ops, [&](const vector<Op>& candidate) {
+                RunResult result = Run(setup, board, options.fullCheck, candidate);
+                return !result.ok && CheckName(result.error) == check;
+            });
+            error = Run(setup, board, options.fullCheck, minimal).error; // Details of the minimal failure
+        }
+        report.ok = false;
+        report.report = FailureReport(caseNumber, setup, error, minimal);
+        return report;
+    }
+    if (!CheckLeaderboard(options.scratch, caseNumber, generated.finished, error)) {
+        report.ok = false;
+        report.report = FailureReport(caseNumber, setup, error, vector<Op>());
+    }
+    return report;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--cases") == 0 && hasValue) {
+            options.cases = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--ops") == 0 && hasValue) {
+            options.ops = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            options.board = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--full-check") == 0 && hasValue) {
+            options.fullCheck = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--case") == 0 && hasValue) {
+            options.onlyCase = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--scratch") == 0 && hasValue) {
+            options.scratch = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--cases N] [--ops N] [--threads T] [--seed S] [--board SIZE] [--full-check N] [--case N] [--scratch DIR]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.cases < 1 || options.ops < 1 || options.fullCheck < 1 || (options.board != 0 && !ValidBoardSize(options.board)) ||
+        options.onlyCase >= options.cases) {
+        fprintf(stderr, "--cases, --ops and --full-check must be positive, --board between 10 and 4096 and --case below --cases\n");
+        return 1;
+    }
+
+    int first = options.onlyCase >= 0 ? options.onlyCase : 0;
+    int last = options.onlyCase >= 0 ? options.onlyCase + 1 : options.cases;
+    vector<CaseReport> reports((size_t)(last - first));
+    ThreadPool pool(options.threads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int caseNumber = first; caseNumber < last; caseNumber++) {
+        pool.Submit([&, caseNumber] {
+            CaseSetup setup = MakeSetup(options, caseNumber);
+            WithBoard(setup.boardSize, [&](auto board) {
+                reports[caseNumber - first] = RunCase(board, setup, caseNumber, options);
+            });
+        });
+    }
+    pool.Wait();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long ops = 0, steps = 0;
+    int games = 0, boardsFilled = 0, failures = 0;
+    for (const CaseReport& report : reports) {
+        ops += report.ops;
+        steps += report.steps;
+        games += report.games;
+        boardsFilled += report.boardsFilled;
+        if (!report.ok) {
+            failures++;
+            fputs(report.report.c_str(), stdout);
+        }
+    }
+    printf("Fuzz: %d cases, seed %llu, %u threads: %ld ops, %ld steps, %d games ended, %d full-board steps\n",
+           last - first, (unsigned long long)options.seed, pool.Size(), ops, steps, games, boardsFilled);
+    printf("  %.2f s, %.2f M ops/s including the replay, %d failing cases\n", elapsed, 2.0 * ops / elapsed / 1e6, failures);
+    return failures == 0 ? 0 : 1;
+}
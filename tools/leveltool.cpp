@@ -0,0 +1,135 @@
+// Level tool: writes level files and checks existing ones.
+//
+// `make` writes a level with random walls covering --walls percent of the
+// board (the starting row stays clear) and, with --messages, one message per
+// line of a text file. `info` maps each file, reports how long opening it
+// took, its rules and wall count, and verifies its checksum; a file that is
+// not a level at all (no "SNLV" magic) is reported with the magic it has.
+//
+//   leveltool make OUT [--size N] [--walls PERCENT] [--seed S] [--messages FILE]
+//   leveltool info FILE...
+
+#include <chrono>       // Timing of Level::Open
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // atoi/atof/strtoull for the command line
+#include <cstring>      // strcmp for the command line, memcmp for the magic
+#include <fstream>      // Reading the message file
+#include <string>       // Messages
+#include <vector>       // Walls and messages
+
+#include "level.h"
+#include "simulation.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Function to write a level from the command line, returns the exit code
+static int MakeLevel(int argc, char** argv) {
+    const char* out = argv[2];
+    LevelDescription level;
+    double wallPercent = 0.0;
+    uint64_t seed = 1;
+    const char* messagesPath = nullptr;
+    for (int i = 3; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--size") == 0 && hasValue) {
+            level.boardSize = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--walls") == 0 && hasValue) {
+            wallPercent = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--messages") == 0 && hasValue) {
+            messagesPath = argv[++i];
+        } else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+    if (!ValidBoardSize(level.boardSize) || wallPercent < 0.0 || wallPercent > 90.0) {
+        fprintf(stderr, "--size must be between 10 and 4096 and --walls between 0 and 90\n");
+        return 1;
+    }
+
+    if (wallPercent > 0.0) {
+        const int size = level.boardSize;
+        level.walls.assign((size_t)size * size, 0);
+        Rng rng(seed);
+        int threshold = (int)(wallPercent * 100.0);
+        for (int y = 0; y < size; y++) {
+            if (y == level.rules.start.y) {
+                continue; // Keep the starting row open, so the snake has room to react
+            }
+            for (int x = 0; x < size; x++) {
+                level.walls[(size_t)y * size + x] = rng.GetRandomValue(0, 9999) < threshold ? 1 : 0;
+            }
+        }
+    }
+    if (messagesPath != nullptr) {
+        ifstream messages(messagesPath);
+        if (!messages) {
+            fprintf(stderr, "Cannot read %s\n", messagesPath);
+            return 1;
+        }
+        for (string line; getline(messages, line);) {
+            level.messages.push_back(line);
+        }
+    }
+    if (!WriteLevel(out, level)) {
+        fprintf(stderr, "Cannot write %s\n", out);
+        return 1;
+    }
+    printf("Wrote %s: %dx%d board, %d messages\n", out, level.boardSize, level.boardSize, (int)level.messages.size());
+    return 0;
+}
+
+// Function to report on level files, returns the exit code
+static int LevelInfo(int argc, char** argv) {
+    int failures = 0;
+    for (int i = 2; i < argc; i++) {
+        Level level;
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bool opened = level.Open(argv[i]);
+        double openMicroseconds = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        if (!opened) {
+            // Name what the file is, so a leaderboard log ("SNKL") or a replay ("SNKR") passed by mistake is obvious
+            char magic[5] = {0, 0, 0, 0, 0};
+            FILE* file = fopen(argv[i], "rb");
+            bool read = file != nullptr && fread(magic, 1, 4, file) == 4;
+            if (file != nullptr) {
+                fclose(file);
+            }
+            if (read && memcmp(magic, "SNLV", 4) != 0) {
+                fprintf(stderr, "%s: not a level file (starts with \"%.4s\", levels start with \"SNLV\")\n", argv[i], magic);
+            } else {
+                fprintf(stderr, "%s: not a valid level\n", argv[i]);
+            }
+            failures++;
+            continue;
+        }
+        int walls = 0;
+        for (int y = 0; y < level.BoardSize(); y++) {
+            for (int x = 0; x < level.BoardSize(); x++) {
+                walls += level.IsWall(Cell{x, y}) ? 1 : 0;
+            }
+        }
+        const LevelRules& rules = level.Rules();
+        bool intact = level.VerifyChecksum();
+        printf("%s: %dx%d board, %d walls, %d messages, start (%d, %d) length %d, margins %d/%d/%d/%d, checksum %08x %s, opened in %.1f us\n",
+               argv[i], level.BoardSize(), level.BoardSize(), walls, level.MessageCount(), rules.start.x, rules.start.y,
+               rules.startLength, rules.foodMargin[0], rules.foodMargin[1], rules.foodMargin[2], rules.foodMargin[3],
+               level.Header().checksum, intact ? "ok" : "MISMATCH", openMicroseconds);
+        failures += intact ? 0 : 1;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc >= 3 && strcmp(argv[1], "make") == 0) {
+        return MakeLevel(argc, argv);
+    }
+    if (argc >= 3 && strcmp(argv[1], "info") == 0) {
+        return LevelInfo(argc, argv);
+    }
+    fprintf(stderr, "usage: %s make OUT [--size N] [--walls PERCENT] [--seed S] [--messages FILE]\n"
+                    "       %s info FILE...\n", argv[0], argv[0]);
+    return 1;
+}
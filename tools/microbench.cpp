@@ -0,0 +1,411 @@
+// Microbenchmarks of the core game operations, in the spirit of Google
+// Benchmark: every case is timed over enough iterations to run for
+// --min-time seconds, repeated --repetitions times, and reported as the
+// median time per operation. Runs headless (no raylib window).
+// `make bench` builds and runs it and writes bench_results.json in Google
+// Benchmark's JSON layout, so runs can be diffed between commits.
+//
+//   microbench [--filter TEXT] [--min-time SECONDS] [--repetitions N] [--json FILE]
+
+#include <algorithm>    // std::sort for medians
+#include <chrono>       // Wall-clock timing
+#include <cstdio>       // printf and the JSON file
+#include <cstdlib>      // atof/atoi for the command line
+#include <cstring>      // strcmp/strstr for the command line
+#include <ctime>        // clock() for CPU time and the report date
+#include <functional>   // std::function holding each case
+#include <memory>       // shared_ptr to the fixtures
+#include <string>       // Case names
+#include <thread>       // hardware_concurrency for the report context
+#include <vector>       // Cases, results and cycles
+
+#include "leaderboard.h"
+#include "simulation.h"
+#include "solver_policy.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Keeps the compiler from optimizing away a value the benchmark computes
+template <typename T>
+static void DoNotOptimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// One benchmark: body(iterations) performs that many operations. The optional
+// setup and teardown build and release a fixture once, outside the timed runs.
+struct BenchCase {
+    string name;
+    function<void(long)> body;
+    function<void()> setup;
+    function<void()> teardown;
+};
+
+// Timing of one benchmark
+struct BenchResult {
+    string name;
+    long iterations; // Operations per repetition
+    double realNs; // Median wall time per operation
+    double cpuNs; // Median CPU time per operation
+};
+
+// Command-line settings
+struct Options {
+    const char* filter = nullptr; // Only run cases whose name contains this
+    double minTime = 0.2; // Seconds each repetition should last
+    int repetitions = 3; // Timed repetitions per case
+    const char* jsonPath = nullptr; // Optional Google Benchmark style JSON output
+};
+
+// Function to time one case: doubles the iteration count until a run lasts minTime, then repeats it
+static BenchResult RunCase(const BenchCase& bench, const Options& options) {
+    if (bench.setup) {
+        bench.setup();
+    }
+    long iterations = 1;
+    while (true) {
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bench.body(iterations);
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (elapsed >= options.minTime || iterations >= (1L << 40)) {
+            break;
+        }
+        // Aim slightly past minTime so the timed runs do not fall short
+        double scale = elapsed > 0 ? options.minTime * 1.2 / elapsed : 1000.0;
+        iterations = (long)(iterations * min(max(scale, 2.0), 1000.0));
+    }
+    vector<double> real, cpu;
+    for (int repetition = 0; repetition < options.repetitions; repetition++) {
+        clock_t cpuStart = clock();
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        bench.body(iterations);
+        real.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations);
+        cpu.push_back((double)(clock() - cpuStart) / CLOCKS_PER_SEC * 1e9 / iterations);
+    }
+    if (bench.teardown) {
+        bench.teardown();
+    }
+    sort(real.begin(), real.end());
+    sort(cpu.begin(), cpu.end());
+    return BenchResult{bench.name, iterations, real[real.size() / 2], cpu[cpu.size() / 2]};
+}
+
+// Function to build a Hamiltonian cycle over the top-left 28x28 cells of the board:
+// along row 0, down in a serpentine over columns 1..27, then back up column 0
+static vector<Cell> BoardCycle() {
+    const int size = 28;
+    vector<Cell> cycle;
+    for (int x = 0; x < size; x++) {
+        cycle.push_back(Cell{x, 0});
+    }
+    for (int y = 1; y < size; y++) {
+        bool leftward = y % 2 == 1;
+        for (int i = 0; i < size - 1; i++) {
+            cycle.push_back(Cell{leftward ? size - 1 - i : 1 + i, y});
+        }
+    }
+    for (int y = size - 1; y >= 1; y--) {
+        cycle.push_back(Cell{0, y});
+    }
+    return cycle;
+}
+
+// Function to lay a snake of 'length' segments along the cycle, head at cycle[length - 1]
+static void LayOnCycle(Snake<DefaultBoard>& snake, const vector<Cell>& cycle, int length) {
+    snake.body.clear();
+    snake.occupancy.Clear();
+    for (int i = length - 1; i >= 0; i--) {
+        snake.body.push_back(cycle[i]);
+        snake.occupancy.Occupy(cycle[i]);
+    }
+    snake.addSegment = false;
+    snake.leftBoard = false;
+}
+
+// Function to return the direction from one cycle cell to the next
+static Cell StepDirection(const vector<Cell>& cycle, size_t from) {
+    Cell a = cycle[from];
+    Cell b = cycle[(from + 1) % cycle.size()];
+    return Cell{b.x - a.x, b.y - a.y};
+}
+
+// Function to return the input that turns toward a direction
+static Input DirectionInput(Cell direction) {
+    if (direction.x == 1) {
+        return Input::RIGHT;
+    }
+    if (direction.x == -1) {
+        return Input::LEFT;
+    }
+    return direction.y == 1 ? Input::DOWN : Input::UP;
+}
+
+// Function to create a leaderboard log holding 'games' random games, with no index yet
+static void FillLeaderboardLog(const string& logPath, const string& indexPath, int games) {
+    {
+        Leaderboard empty;
+        empty.Open(logPath, indexPath); // Writes the log header
+    }
+    remove(indexPath.c_str()); // Leave the index to be rebuilt from the log
+    FILE* log = fopen(logPath.c_str(), "ab");
+    Rng rng(5);
+    for (int i = 0; i < games; i++) {
+        LeaderboardRecord record = {};
+        record.time = i;
+        record.score = rng.GetRandomValue(0, 5000) * 10;
+        record.level = (uint8_t)rng.GetRandomValue(0, 3);
+        record.nameLength = 1;
+        record.name[0] = 'p';
+        record.commit = leaderboardCommit;
+        fwrite(&record, sizeof(record), 1, log);
+    }
+    fclose(log);
+}
+
+// Snake of a case, laid out by the case's setup so the timed body only runs the operation
+struct SnakeFixture {
+    Snake<DefaultBoard> snake{DefaultBoard{}};
+    Rng rng; // Picks of the lookup and spawn cases
+    size_t head = 0; // Cycle index of the head, kept between runs
+};
+
+static vector<BenchCase> BuildCases(const string& scratchPrefix) {
+    vector<BenchCase> cases;
+    vector<Cell> cycle = BoardCycle();
+    const int area = DefaultBoard::Area();
+
+    // Snake::Update: one move along the cycle; the cost must not depend on the length
+    for (int length : {3, 64, 512, 780}) {
+        shared_ptr<SnakeFixture> fixture = make_shared<SnakeFixture>();
+        cases.push_back({"Snake::Update/length:" + to_string(length), [fixture, cycle](long iterations) {
+            Snake<DefaultBoard>& snake = fixture->snake;
+            size_t head = fixture->head;
+            for (long i = 0; i < iterations; i++) {
+                snake.direction = StepDirection(cycle, head);
+                snake.Update();
+                head = (head + 1) % cycle.size();
+            }
+            fixture->head = head;
+            DoNotOptimize(snake.body.front());
+        }, [fixture, cycle, length] {
+            LayOnCycle(fixture->snake, cycle, length);
+            fixture->head = length - 1;
+        }});
+    }
+
+    // CheckCollisionWithTail is HeadHitsBody() plus the game-over branch
+    for (int length : {3, 780}) {
+        shared_ptr<SnakeFixture> fixture = make_shared<SnakeFixture>();
+        cases.push_back({"CheckCollisionWithTail/length:" + to_string(length), [fixture](long iterations) {
+            bool hit = false;
+            for (long i = 0; i < iterations; i++) {
+                hit ^= fixture->snake.HeadHitsBody();
+                DoNotOptimize(hit);
+            }
+        }, [fixture, cycle, length] {
+            LayOnCycle(fixture->snake, cycle, length);
+        }});
+    }
+
+    // ElementInDeque (the old body scan) became a single occupancy-grid lookup
+    for (int length : {3, 780}) {
+        shared_ptr<SnakeFixture> fixture = make_shared<SnakeFixture>();
+        cases.push_back({"OccupancyLookup/length:" + to_string(length), [fixture, area](long iterations) {
+            int hits = 0;
+            for (long i = 0; i < iterations; i++) {
+                Cell cell = DefaultBoard::CellAt(fixture->rng.GetRandomValue(0, area - 1));
+                hits += fixture->snake.occupancy.IsOccupied(cell) ? 1 : 0;
+            }
+            DoNotOptimize(hits);
+        }, [fixture, cycle, length] {
+            LayOnCycle(fixture->snake, cycle, length);
+            fixture->rng = Rng(7);
+        }});
+    }
+
+    // Food::GenerateRandomPos with 0..99% of the board occupied: the snake covers the cycle
+    // and the cells beyond it (column and row 28) are occupied directly
+    for (int percent : {0, 25, 50, 90, 99}) {
+        shared_ptr<SnakeFixture> fixture = make_shared<SnakeFixture>();
+        cases.push_back({"Food::GenerateRandomPos/fill:" + to_string(percent), [fixture](long iterations) {
+            Food<DefaultBoard> food(SpeedLevel::VERY_FAST, fixture->rng);
+            Cell position = {0, 0};
+            for (long i = 0; i < iterations; i++) {
+                food.GenerateRandomPos(fixture->snake, position);
+                DoNotOptimize(position);
+            }
+        }, [fixture, cycle, percent, area] {
+            int occupied = max(1, area * percent / 100);
+            Snake<DefaultBoard>& snake = fixture->snake;
+            LayOnCycle(snake, cycle, min((int)cycle.size(), occupied));
+            snake.occupancy.SetSpawnMargin(0);
+            int extra = occupied - (int)snake.body.size();
+            for (int index = 0; index < area && extra > 0; index++) {
+                Cell cell = DefaultBoard::CellAt(index);
+                if (!snake.occupancy.IsOccupied(cell)) {
+                    snake.occupancy.Occupy(cell);
+                    extra--;
+                }
+            }
+            fixture->rng = Rng(11);
+        }});
+    }
+
+    // A whole simulation step with the snake steered along the cycle (eats, respawns, collision checks)
+    shared_ptr<Simulation> stepSim = make_shared<Simulation>(3, SpeedLevel::VERY_FAST);
+    shared_ptr<size_t> stepHead = make_shared<size_t>(2);
+    cases.push_back({"Simulation::Step/cycle", [stepSim, stepHead, cycle](long iterations) {
+        Simulation& sim = *stepSim;
+        size_t head = *stepHead;
+        for (long i = 0; i < iterations; i++) {
+            unsigned events = sim.Step(DirectionInput(StepDirection(cycle, head)));
+            head = (head + 1) % cycle.size();
+            if (events & EVENT_GAME_OVER || sim.snake.body.size() >= cycle.size() - 1) {
+                LayOnCycle(sim.snake, cycle, 3); // Start over before the snake fills the cycle
+                head = 2;
+            }
+            DoNotOptimize(events);
+        }
+        *stepHead = head;
+    }, [stepSim, stepHead, cycle] {
+        Simulation& sim = *stepSim;
+        LayOnCycle(sim.snake, cycle, 3);
+        sim.snake.occupancy.SetSpawnMargin(sim.food.GetMinDistance());
+        sim.food.Respawn(sim.snake);
+        *stepHead = 2;
+    }});
+
+    // One solver decision plus the step it drives, over whole games on the 29x29 board (includes restarts)
+    shared_ptr<Simulation> solverSim = make_shared<Simulation>(5, SpeedLevel::VERY_FAST);
+    shared_ptr<SolverPolicy<DefaultBoard>> solver = make_shared<SolverPolicy<DefaultBoard>>();
+    cases.push_back({"SolverPolicy::Decide+Step/game", [solverSim, solver](long iterations) {
+        Simulation& sim = *solverSim;
+        uint64_t seed = 5;
+        for (long i = 0; i < iterations; i++) {
+            unsigned events = sim.Step(solver->Decide(sim));
+            if (events & (EVENT_GAME_OVER | EVENT_BOARD_FULL)) {
+                sim.Restart(++seed, SpeedLevel::VERY_FAST);
+                solver->Reset();
+            }
+            DoNotOptimize(events);
+        }
+    }, [solverSim, solver] {
+        solverSim->Restart(5, SpeedLevel::VERY_FAST);
+        solver->Reset();
+    }});
+
+    // SortLeaderboard became Leaderboard: inserting a game and reading the top 10 with n games logged.
+    // The log fill, the index rebuild on Open() and the games behind Top are fixture, not timed.
+    string logPath = scratchPrefix + ".log";
+    string indexPath = scratchPrefix + ".idx";
+    auto removeScratch = [logPath, indexPath] {
+        remove(logPath.c_str());
+        remove(indexPath.c_str());
+    };
+    for (int games : {1000, 10000, 100000}) {
+        shared_ptr<Leaderboard> leaderboard = make_shared<Leaderboard>();
+        shared_ptr<Rng> rng = make_shared<Rng>(9);
+        cases.push_back({"Leaderboard::Add/games:" + to_string(games), [leaderboard, rng](long iterations) {
+            for (long i = 0; i < iterations; i++) {
+                leaderboard->Add("bench", rng->GetRandomValue(0, 5000) * 10, SpeedLevel::FAST, i);
+            }
+        }, [=] {
+            removeScratch();
+            FillLeaderboardLog(logPath, indexPath, games);
+            leaderboard->Open(logPath, indexPath);
+        }, [=] {
+            leaderboard->Close();
+            removeScratch();
+        }});
+    }
+    shared_ptr<Leaderboard> topBoard = make_shared<Leaderboard>();
+    cases.push_back({"Leaderboard::Top/count:10", [topBoard](long iterations) {
+        for (long i = 0; i < iterations; i++) {
+            vector<LeaderboardEntry> top = topBoard->Top(SpeedLevel::FAST, 10);
+            DoNotOptimize(top.data());
+        }
+    }, [=] {
+        removeScratch();
+        topBoard->Open(logPath, indexPath);
+        Rng rng(13);
+        for (int i = 0; i < 400; i++) {
+            topBoard->Add("bench", rng.GetRandomValue(0, 5000) * 10, (SpeedLevel)(i % 4), i);
+        }
+    }, [=] {
+        topBoard->Close();
+        removeScratch();
+    }});
+    return cases;
+}
+
+// Function to write the results in Google Benchmark's JSON layout
+static bool WriteJson(const char* path, const vector<BenchResult>& results) {
+    FILE* file = fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    fprintf(file, "{\n  \"context\": {\n    \"date\": \"%s\",\n    \"executable\": \"microbench\",\n    \"num_cpus\": %u,\n", date,
+            thread::hardware_concurrency());
+#ifdef NDEBUG
+    fprintf(file, "    \"library_build_type\": \"release\"\n  },\n");
+#else
+    fprintf(file, "    \"library_build_type\": \"debug\"\n  },\n");
+#endif
+    fprintf(file, "  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        fprintf(file,
+                "    {\n      \"name\": \"%s\",\n      \"run_type\": \"aggregate\",\n      \"aggregate_name\": \"median\",\n"
+                "      \"iterations\": %ld,\n      \"real_time\": %.3f,\n      \"cpu_time\": %.3f,\n      \"time_unit\": \"ns\"\n    }%s\n",
+                result.name.c_str(), result.iterations, result.realNs, result.cpuNs, i + 1 < results.size() ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    return fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minTime = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--repetitions") == 0 && hasValue) {
+            options.repetitions = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--filter TEXT] [--min-time SECONDS] [--repetitions N] [--json FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (options.repetitions < 1 || options.minTime <= 0) {
+        fprintf(stderr, "--repetitions and --min-time must be positive\n");
+        return 1;
+    }
+
+    vector<BenchResult> results;
+    printf("%-40s %14s %14s %12s\n", "Benchmark", "Time (ns)", "CPU (ns)", "Iterations");
+    for (const BenchCase& bench : BuildCases("microbench_scratch")) {
+        if (options.filter != nullptr && strstr(bench.name.c_str(), options.filter) == nullptr) {
+            continue;
+        }
+        results.push_back(RunCase(bench, options));
+        const BenchResult& result = results.back();
+        printf("%-40s %14.2f %14.2f %12ld\n", result.name.c_str(), result.realNs, result.cpuNs, result.iterations);
+        fflush(stdout);
+    }
+    if (options.jsonPath != nullptr && !WriteJson(options.jsonPath, results)) {
+        fprintf(stderr, "Cannot write %s\n", options.jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Replay checker: memory-maps replay files, validates them and re-simulates
+// every run from its first keyframe, comparing each later keyframe and the
+// final score with what the simulation reproduces. Files are checked in
+// parallel. With --seek, also times a seek to that tick in every replay.
+// Runs played on a level need that level file, passed with --level.
+//
+//   replaycheck [--threads T] [--seek TICK] [--level FILE] FILE...
+
+#include <algorithm>    // std::equal/min/max
+#include <chrono>       // Timing of the checks and seeks
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // atoi/atol for the command line
+#include <cstring>      // strcmp for the command line
+#include <string>       // Failure messages
+#include <vector>       // File list and results
+
+#include "level.h"
+#include "mapped_file.h"
+#include "replay.h"
+#include "simulation.h"
+#include "thread_pool.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Outcome of checking one file
+struct CheckResult {
+    bool ok = false; // True if the replay reproduced exactly
+    string message; // Reason of the failure
+    uint32_t ticks = 0; // Recorded steps
+    double seekMicroseconds = 0.0; // Time of the --seek, if requested
+};
+
+// Function to compare two states field by field
+static bool SameState(const SimulationState& a, const SimulationState& b) {
+    return a.rngState == b.rngState && a.speedLevel == b.speedLevel &&
+           a.difficultyHasChanged == b.difficultyHasChanged && a.newDifficulty == b.newDifficulty &&
+           a.body.size() == b.body.size() && equal(a.body.begin(), a.body.end(), b.body.begin()) &&
+           a.direction == b.direction && a.addSegment == b.addSegment && a.foodPosition == b.foodPosition &&
+           a.foodPlaced == b.foodPlaced && a.running == b.running && a.score == b.score &&
+           a.lastScore == b.lastScore && a.foodEaten == b.foodEaten && a.freeSpawnCells == b.freeSpawnCells;
+}
+
+// Function to re-simulate a whole replay and compare it with its keyframes
+template <typename BoardT>
+static void Verify(BoardT board, const ReplayReader& reader, const Level* level, long seekTick, CheckResult& result) {
+    const ReplayHeader& header = reader.Header();
+    BasicSimulation<BoardT> sim(header.seed, (SpeedLevel)header.difficulty, board);
+    if (header.levelChecksum != 0) {
+        if (level == nullptr || level->Header().checksum != header.levelChecksum || !level->Apply(sim)) {
+            char checksum[16];
+            snprintf(checksum, sizeof(checksum), "%08x", header.levelChecksum);
+            result.message = string("was played on level ") + checksum + ", pass that level with --level";
+            return;
+        }
+    }
+    SimulationState expected, actual;
+    if (!reader.ReadKeyframe(0, expected)) {
+        result.message = "keyframe 0 is damaged";
+        return;
+    }
+    sim.LoadState(expected);
+    ReplayInputCursor cursor = reader.CursorAt(0);
+    uint32_t nextKeyframe = 1;
+    unsigned events = 0;
+    for (uint32_t tick = reader.Keyframe(0).tick; tick < header.tickCount; tick++) {
+        if (nextKeyframe < header.keyframeCount && reader.Keyframe(nextKeyframe).tick == tick) {
+            if (!reader.ReadKeyframe(nextKeyframe, expected)) {
+                result.message = "keyframe " + to_string(nextKeyframe) + " is damaged";
+                return;
+            }
+            sim.SaveState(actual);
+            if (!SameState(expected, actual)) {
+                result.message = "diverges before tick " + to_string(tick);
+                return;
+            }
+            nextKeyframe++;
+        }
+        events = sim.Step(cursor.InputAt(tick));
+    }
+    if (header.tickCount > 0 && (!(events & EVENT_GAME_OVER) || sim.lastScore != header.finalScore)) {
+        result.message = "ends with score " + to_string(sim.lastScore) + ", file says " + to_string(header.finalScore);
+        return;
+    }
+
+    if (seekTick >= 0) {
+        uint32_t tick = (uint32_t)min(seekTick, (long)header.tickCount);
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        if (!reader.Seek(sim, tick)) {
+            result.message = "seek to tick " + to_string(tick) + " failed";
+            return;
+        }
+        result.seekMicroseconds = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    }
+    result.ok = true;
+}
+
+// Function to check one file
+static CheckResult CheckFile(const char* path, const Level* level, long seekTick) {
+    CheckResult result;
+    MappedFile file;
+    ReplayReader reader;
+    if (!file.Open(path)) {
+        result.message = "cannot be mapped";
+        return result;
+    }
+    if (!reader.Open(file.Data(), file.Size())) {
+        result.message = "is not a valid replay";
+        return result;
+    }
+    result.ticks = reader.Header().tickCount;
+    if (!WithBoard((int)reader.Header().boardSize, [&](auto board) { Verify(board, reader, level, seekTick, result); })) {
+        result.message = "has an unsupported board size";
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    unsigned threads = 0;
+    long seekTick = -1;
+    const char* levelPath = nullptr;
+    vector<const char*> paths;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seek") == 0 && hasValue) {
+            seekTick = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--level") == 0 && hasValue) {
+            levelPath = argv[++i];
+        } else if (argv[i][0] == '-') {
+            paths.clear();
+            break;
+        } else {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (paths.empty()) {
+        fprintf(stderr, "usage: %s [--threads T] [--seek TICK] [--level FILE] FILE...\n", argv[0]);
+        return 1;
+    }
+    Level level;
+    if (levelPath != nullptr && !level.Open(levelPath)) {
+        fprintf(stderr, "%s is not a valid level\n", levelPath);
+        return 1;
+    }
+
+    vector<CheckResult> results(paths.size());
+    ThreadPool pool(threads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0; i < paths.size(); i++) {
+        pool.Submit([&, i] { results[i] = CheckFile(paths[i], level.IsOpen() ? &level : nullptr, seekTick); });
+    }
+    pool.Wait();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    int failures = 0;
+    long totalTicks = 0;
+    double worstSeek = 0.0;
+    for (size_t i = 0; i < paths.size(); i++) {
+        if (!results[i].ok) {
+            fprintf(stderr, "%s: %s\n", paths[i], results[i].message.c_str());
+            failures++;
+        }
+        totalTicks += results[i].ticks;
+        worstSeek = max(worstSeek, results[i].seekMicroseconds);
+    }
+    printf("%d of %d replays reproduced, %ld ticks re-simulated in %.3f s on %u threads\n",
+           (int)paths.size() - failures, (int)paths.size(), totalTicks, elapsed, pool.Size());
+    if (seekTick >= 0) {
+        printf("Slowest seek to tick %ld: %.1f us\n", seekTick, worstSeek);
+    }
+    return failures == 0 ? 0 : 1;
+}
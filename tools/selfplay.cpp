@@ -0,0 +1,241 @@
+// Batch self-play: runs many independent games per SpeedLevel with the greedy
+// policy (or the solver, --policy solver) and reports score, length and
+// duration distributions. Every game's seed is derived from --seed, the level
+// and the game number, so results do not depend on the thread count or on
+// scheduling. A game also ends, as cleared, once no free cell is left for food.
+// --level plays on a level file (its board size replaces --board).
+// --speed-curves times the games with a curve file, --curve with one of its
+// custom curves at every level.
+//
+//   selfplay [--games N] [--threads T] [--seed S] [--board SIZE] [--level FILE] [--max-ticks M] [--policy greedy|solver]
+//            [--speed-curves FILE] [--curve NAME] [--csv FILE]
+
+#include <algorithm>    // std::sort for percentiles
+#include <chrono>       // Wall-clock timing of the batch
+#include <cstdio>       // printf/fprintf for the report
+#include <cstdlib>      // strtoull/atoi for the command line
+#include <cstring>      // strcmp for the command line
+#include <string>       // Speed curve errors
+#include <vector>       // Per-game results
+
+#include "greedy_policy.h"
+#include "level.h"
+#include "simulation.h"
+#include "solver_policy.h"
+#include "thread_pool.h"
+
+using namespace std;    // Use the standard namespace to avoid prefixing with 'std::'
+
+// Outcome of one self-played game
+struct GameResult {
+    int score; // Score when the run ended
+    int length; // Snake length reached
+    long ticks; // Simulation steps played
+    double seconds; // Game time those steps take at the level's update intervals
+    bool capped; // True if the game hit --max-ticks instead of ending
+    bool cleared; // True if the snake filled every cell food could spawn on
+};
+
+// Command-line settings
+struct Options {
+    int games = 1000; // Games per speed level
+    unsigned threads = 0; // Worker threads, 0 = one per hardware thread
+    uint64_t seed = 1; // Base seed of the whole batch
+    int board = cellCount; // Board side length
+    long maxTicks = 1000000; // Safety cap per game
+    bool solver = false; // Play with SolverPolicy instead of GreedyPolicy
+    const char* levelPath = nullptr; // Optional level to play on
+    const Level* level = nullptr; // That level, once opened
+    const char* curvesPath = nullptr; // Optional speed curve file
+    const char* curveName = nullptr; // Optional curve timing every level
+    SpeedCurveSet curves; // Curves loaded from 'curvesPath', or the classic ones
+    const SpeedCurve* curve = nullptr; // The curve named by 'curveName', once found
+    const char* csvPath = nullptr; // Optional per-game output
+};
+
+static const SpeedLevel levels[] = {SpeedLevel::SLOW, SpeedLevel::MEDIUM, SpeedLevel::FAST, SpeedLevel::VERY_FAST};
+static const int gamesPerTask = 32; // Games run back to back by one task
+
+// Function to derive an independent seed for one game
+static uint64_t GameSeed(uint64_t baseSeed, int level, int game) {
+    Rng mixer(baseSeed ^ ((uint64_t)level << 56) ^ (uint64_t)game);
+    return mixer.Next();
+}
+
+// Function to play one game until it ends or reaches the tick cap
+template <typename BoardT>
+static GameResult PlayGame(BoardT board, SpeedLevel level, uint64_t seed, const Options& options, SolverPolicy<BoardT>& solver) {
+    BasicSimulation<BoardT> sim(seed, level, board);
+    if (options.level != nullptr) {
+        options.level->Apply(sim);
+        sim.Restart(seed, level); // Same seed, so the game does not depend on the board it was constructed on
+    }
+    sim.SetSpeedCurves(options.curves);
+    solver.Reset(); // Its last decision was for the previous game
+    GameResult result = {0, 0, 0, 0.0, true, false};
+    while (result.ticks < options.maxTicks) {
+        result.seconds += (options.curve != nullptr ? options.curve->PeriodAt(sim.score) : sim.GetTickPeriod()) / 1e6;
+        unsigned events = sim.Step(options.solver ? solver.Decide(sim) : GreedyPolicy(sim));
+        result.ticks++;
+        if (events & EVENT_GAME_OVER) {
+            result.capped = false;
+            break;
+        }
+        if (events & EVENT_BOARD_FULL) {
+            result.capped = false;
+            result.cleared = true;
+            break;
+        }
+    }
+    result.score = result.capped || result.cleared ? sim.score : sim.lastScore;
+    result.length = 3 + result.score / 10; // Every food adds one segment to the three-cell start
+    return result;
+}
+
+// Function to return the value at percentile p of a sorted list
+template <typename T>
+static T Percentile(const vector<T>& sorted, double p) {
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index];
+}
+
+// Function to print one distribution line
+template <typename T>
+static void PrintDistribution(const char* name, vector<T> values) {
+    sort(values.begin(), values.end());
+    double sum = 0;
+    for (T value : values) {
+        sum += value;
+    }
+    printf("  %-8s mean %9.1f  p10 %7.0f  p50 %7.0f  p90 %7.0f  p99 %7.0f  max %7.0f\n", name, sum / values.size(),
+           (double)Percentile(values, 0.10), (double)Percentile(values, 0.50), (double)Percentile(values, 0.90),
+           (double)Percentile(values, 0.99), (double)values.back());
+}
+
+template <typename BoardT>
+static void RunBatch(BoardT board, const Options& options) {
+    int levelCount = (int)(sizeof(levels) / sizeof(levels[0]));
+    vector<GameResult> results((size_t)levelCount * options.games);
+
+    ThreadPool pool(options.threads);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (int level = 0; level < levelCount; level++) {
+        for (int first = 0; first < options.games; first += gamesPerTask) {
+            int last = min(first + gamesPerTask, options.games);
+            pool.Submit([&, board, level, first, last] {
+                SolverPolicy<BoardT> solver(board); // Its buffers are reused by every game of the task
+                for (int game = first; game < last; game++) {
+                    uint64_t seed = GameSeed(options.seed, level, game);
+                    results[(size_t)level * options.games + game] = PlayGame(board, levels[level], seed, options, solver);
+                }
+            });
+        }
+    }
+    pool.Wait();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long totalTicks = 0;
+    for (const GameResult& result : results) {
+        totalTicks += result.ticks;
+    }
+    printf("Self-play (%s): %d games x %d levels on a %dx%d board, seed %llu, %u threads\n", options.solver ? "solver" : "greedy",
+           options.games, levelCount, board.CellCount(), board.CellCount(), (unsigned long long)options.seed, pool.Size());
+    printf("Wall time %.3f s, %.0f games/s, %.2f M ticks/s\n\n", elapsed, results.size() / elapsed, totalTicks / elapsed / 1e6);
+
+    for (int level = 0; level < levelCount; level++) {
+        vector<int> scores, lengths;
+        vector<long> ticks;
+        vector<double> seconds;
+        int capped = 0, cleared = 0;
+        for (int game = 0; game < options.games; game++) {
+            const GameResult& result = results[(size_t)level * options.games + game];
+            scores.push_back(result.score);
+            lengths.push_back(result.length);
+            ticks.push_back(result.ticks);
+            seconds.push_back(result.seconds);
+            capped += result.capped ? 1 : 0;
+            cleared += result.cleared ? 1 : 0;
+        }
+        printf("%s (food margin %d, %d capped, %d cleared)\n", SpeedLevelToString(levels[level]).c_str(),
+               options.level != nullptr ? options.level->Rules().foodMargin[(int)levels[level]] : FoodMinDistance(levels[level]),
+               capped, cleared);
+        PrintDistribution("score", scores);
+        PrintDistribution("length", lengths);
+        PrintDistribution("ticks", ticks);
+        PrintDistribution("seconds", seconds);
+    }
+
+    if (options.csvPath != nullptr) {
+        FILE* csv = fopen(options.csvPath, "w");
+        if (csv == nullptr) {
+            fprintf(stderr, "Cannot write %s\n", options.csvPath);
+            return;
+        }
+        fprintf(csv, "level,game,seed,score,length,ticks,seconds,capped,cleared\n");
+        for (int level = 0; level < levelCount; level++) {
+            for (int game = 0; game < options.games; game++) {
+                const GameResult& result = results[(size_t)level * options.games + game];
+                fprintf(csv, "%s,%d,%llu,%d,%d,%ld,%.3f,%d,%d\n", SpeedLevelToString(levels[level]).c_str(), game,
+                        (unsigned long long)GameSeed(options.seed, level, game), result.score, result.length,
+                        result.ticks, result.seconds, result.capped ? 1 : 0, result.cleared ? 1 : 0);
+            }
+        }
+        fclose(csv);
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && hasValue) {
+            options.games = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && hasValue) {
+            options.threads = (unsigned)atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (strcmp(argv[i], "--board") == 0 && hasValue) {
+            options.board = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--level") == 0 && hasValue) {
+            options.levelPath = argv[++i];
+        } else if (strcmp(argv[i], "--max-ticks") == 0 && hasValue) {
+            options.maxTicks = atol(argv[++i]);
+        } else if (strcmp(argv[i], "--policy") == 0 && hasValue && (strcmp(argv[i + 1], "greedy") == 0 || strcmp(argv[i + 1], "solver") == 0)) {
+            options.solver = strcmp(argv[++i], "solver") == 0;
+        } else if (strcmp(argv[i], "--speed-curves") == 0 && hasValue) {
+            options.curvesPath = argv[++i];
+        } else if (strcmp(argv[i], "--curve") == 0 && hasValue) {
+            options.curveName = argv[++i];
+        } else if (strcmp(argv[i], "--csv") == 0 && hasValue) {
+            options.csvPath = argv[++i];
+        } else {
+            fprintf(stderr, "usage: %s [--games N] [--threads T] [--seed S] [--board SIZE] [--level FILE] [--max-ticks M] [--policy greedy|solver]"
+                            " [--speed-curves FILE] [--curve NAME] [--csv FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+    string error;
+    if (options.curvesPath != nullptr && !options.curves.Load(options.curvesPath, error)) {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (options.curveName != nullptr && (options.curve = options.curves.Find(options.curveName)) == nullptr) {
+        fprintf(stderr, "No speed curve named %s\n", options.curveName);
+        return 1;
+    }
+    Level level;
+    if (options.levelPath != nullptr) {
+        if (!level.Open(options.levelPath)) {
+            fprintf(stderr, "%s is not a valid level\n", options.levelPath);
+            return 1;
+        }
+        options.level = &level;
+        options.board = level.BoardSize();
+    }
+    if (options.games < 1 || !ValidBoardSize(options.board)) {
+        fprintf(stderr, "--games must be positive and --board between 10 and 4096\n");
+        return 1;
+    }
+    WithBoard(options.board, [&](auto board) { RunBatch(board, options); });
+    return 0;
+}